@@ -0,0 +1,60 @@
+/**
+ * @author Heitor Barreto e Vinícius Lopes
+ * @date Julho de 2025
+ */
+
+/*
+ * Micro-benchmark do reconhecimento de palavras reservadas: compara o
+ * despacho por (tamanho, primeiro caractere) de verificar_palavra_reservada()
+ * com a sequência de strcmp original. A função é interna ao analisador
+ * léxico, então este arquivo inclui compilador.c em vez de ligá-lo.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../compilador.c"
+
+#define CONSULTAS 20000000L
+
+static double agora_ns(void) {
+    struct timespec t;
+    timespec_get(&t, TIME_UTC);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/* O reconhecimento de antes: uma comparação por palavra reservada, em ordem. */
+static TipoToken palavra_reservada_por_strcmp(const char* texto) {
+    for (int tipo = TOKEN_PRINCIPAL; tipo <= TOKEN_DECIMAL; tipo++) {
+        if (strcmp(texto, palavras_reservadas[tipo]) == 0) return (TipoToken) tipo;
+    }
+    return TOKEN_ERRO;
+}
+
+int main(void) {
+    /* Mistura com peso nos tipos, as palavras mais frequentes nos programas, e dois não reservados. */
+    static const char* const palavras[] = {
+        "inteiro", "texto", "decimal", "inteiro", "se", "escreva",
+        "para", "principal", "inteir", "foo", "texto", "decimal"
+    };
+    enum { TOTAL_PALAVRAS = sizeof(palavras) / sizeof(palavras[0]) };
+    size_t tamanhos[TOTAL_PALAVRAS];
+    for (int i = 0; i < TOTAL_PALAVRAS; i++) {
+        tamanhos[i] = strlen(palavras[i]);
+    }
+
+    volatile long soma = 0;
+    double inicio = agora_ns();
+    for (long i = 0; i < CONSULTAS; i++) {
+        soma += palavra_reservada_por_strcmp(palavras[i % TOTAL_PALAVRAS]);
+    }
+    double meio = agora_ns();
+    for (long i = 0; i < CONSULTAS; i++) {
+        soma += verificar_palavra_reservada(palavras[i % TOTAL_PALAVRAS], tamanhos[i % TOTAL_PALAVRAS]);
+    }
+    double fim = agora_ns();
+
+    printf("strcmp sequencial:        %.2f ns/palavra\n", (meio - inicio) / CONSULTAS);
+    printf("despacho tamanho+inicial: %.2f ns/palavra\n", (fim - meio) / CONSULTAS);
+    return soma == 0;
+}
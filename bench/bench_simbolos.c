@@ -0,0 +1,71 @@
+/**
+ * @author Heitor Barreto e Vinícius Lopes
+ * @date Julho de 2025
+ */
+
+/*
+ * Micro-benchmark da busca na tabela de símbolos: compara o índice hash de
+ * buscar_variavel() com a varredura da lista ligada por strcmp, que era a
+ * busca original. Cada busca inclui o sprintf do nome, como no parser.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../compilador.h"
+
+#define BUSCAS 200000
+
+static double agora_ns(void) {
+    struct timespec t;
+    timespec_get(&t, TIME_UTC);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/* A busca de antes do índice: percorre a lista comparando os nomes. */
+static EntradaTabela* buscar_variavel_linear(ContextoCompilador* ctx, const char* nome) {
+    for (EntradaTabela* atual = ctx->tabela_simbolos->primeira; atual != NULL; atual = atual->proxima) {
+        if (strcmp(atual->nome, nome) == 0) {
+            return atual;
+        }
+    }
+    return NULL;
+}
+
+int main(void) {
+    static const int marcos[] = {1000, 4000, 16000};
+    ContextoCompilador contexto;
+    ContextoCompilador* ctx = &contexto;
+    inicializar_contexto(ctx);
+    configurar_orcamento_memoria(ctx, 1024 * 1024, 100);
+    inicializar_tabela_nomes(ctx);
+    inicializar_tabela_simbolos(ctx);
+
+    printf("%-11s | %-14s | %s\n", "VARIÁVEIS", "LISTA (ns)", "ÍNDICE (ns)");
+    char nome[32];
+    int total = 0;
+    volatile long encontradas = 0;
+    for (int m = 0; m < (int) (sizeof(marcos) / sizeof(marcos[0])); m++) {
+        while (total < marcos[m]) {
+            sprintf(nome, "!v%d", total++);
+            adicionar_variavel(ctx, nome, TIPO_INTEIRO, "principal", (LimitadorTamanho){0, 0}, 0);
+        }
+
+        double inicio = agora_ns();
+        for (int i = 0; i < BUSCAS; i++) {
+            sprintf(nome, "!v%d", (i * 7919) % total);
+            encontradas += buscar_variavel_linear(ctx, nome) != NULL;
+        }
+        double meio = agora_ns();
+        for (int i = 0; i < BUSCAS; i++) {
+            sprintf(nome, "!v%d", (i * 7919) % total);
+            encontradas += buscar_variavel(ctx, nome) != NULL;
+        }
+        double fim = agora_ns();
+
+        printf("%-10d | %-14.0f | %.0f\n", total, (meio - inicio) / BUSCAS, (fim - meio) / BUSCAS);
+    }
+
+    destruir_contexto(ctx);
+    return encontradas == 2L * BUSCAS * 3 ? 0 : 1;
+}
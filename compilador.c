@@ -6,61 +6,516 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#include <errno.h>
 #include "compilador.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define FONTE_USA_MMAP 1
+#endif
+
 /* --- CONTROLE DE MEMÓRIA --- */ 
 
-#define MEMORIA_MAXIMA_KB 2048
-long MEMORIA_TOTAL_DISPONIVEL = MEMORIA_MAXIMA_KB * 1024;
-long memoria_alocada_atual = 0;
-long memoria_pico_utilizada = 0;
-int alerta_memoria_emitido = 0;
+#define MEMORIA_MAXIMA_KB 8192
+#define PERCENTUAL_ALERTA_MEMORIA 90
+
+/* --- PERFIL DE ALOCAÇÕES --- */
+
+static const char* const nomes_categorias[TOTAL_CATEGORIAS] = {
+    "tokens", "nomes", "simbolos", "funcoes", "pilha", "arvore"
+};
+
+void configurar_perfil_memoria(ContextoCompilador* ctx) {
+    const char* valor = getenv("COMPILADOR_PERFIL_MEMORIA");
+    ctx->memoria.perfil_ativo = valor != NULL && strcmp(valor, "0") != 0;
+    memset(ctx->memoria.perfil, 0, sizeof(ctx->memoria.perfil));
+}
+
+static int faixa_histograma(size_t tamanho) {
+    int faixa = 0;
+    size_t limite = 16;
+    while (faixa < TOTAL_FAIXAS_HISTOGRAMA - 1 && tamanho > limite) {
+        limite *= 4;
+        faixa++;
+    }
+    return faixa;
+}
+
+static void registrar_alocacao(ContextoCompilador* ctx, CategoriaMemoria categoria, size_t tamanho) {
+    PerfilCategoria* perfil = &ctx->memoria.perfil[categoria];
+    perfil->alocacoes++;
+    perfil->bytes_totais += (long) tamanho;
+    perfil->bytes_atuais += (long) tamanho;
+    if (perfil->bytes_atuais > perfil->bytes_pico) {
+        perfil->bytes_pico = perfil->bytes_atuais;
+    }
+    perfil->histograma[faixa_histograma(tamanho)]++;
+}
+
+static void registrar_liberacao(ContextoCompilador* ctx, CategoriaMemoria categoria, size_t tamanho) {
+    ctx->memoria.perfil[categoria].liberacoes++;
+    ctx->memoria.perfil[categoria].bytes_atuais -= (long) tamanho;
+}
+
+static void exibir_perfil_memoria(ContextoCompilador* ctx) {
+    fprintf(ctx->saida, "\n------------- PERFIL DE ALOCAÇÕES -------------\n");
+    fprintf(ctx->saida, "%-10s | %9s | %9s | %12s | %12s\n", "CATEGORIA", "ALOCAÇÕES", "LIBERAÇÕES", "BYTES TOTAIS", "PICO (bytes)");
+    for (int i = 0; i < TOTAL_CATEGORIAS; i++) {
+        PerfilCategoria* perfil = &ctx->memoria.perfil[i];
+        fprintf(ctx->saida, "%-10s | %9ld | %10ld | %12ld | %12ld\n", nomes_categorias[i],
+               perfil->alocacoes, perfil->liberacoes, perfil->bytes_totais, perfil->bytes_pico);
+    }
+    fprintf(ctx->saida, "\nHistograma de tamanhos (alocações por faixa de bytes):\n");
+    fprintf(ctx->saida, "%-10s | %6s %6s %6s %6s %6s %6s %6s %6s\n", "CATEGORIA",
+           "<=16", "<=64", "<=256", "<=1K", "<=4K", "<=16K", "<=64K", ">64K");
+    for (int i = 0; i < TOTAL_CATEGORIAS; i++) {
+        fprintf(ctx->saida, "%-10s |", nomes_categorias[i]);
+        for (int faixa = 0; faixa < TOTAL_FAIXAS_HISTOGRAMA; faixa++) {
+            fprintf(ctx->saida, " %6ld", ctx->memoria.perfil[i].histograma[faixa]);
+        }
+        fprintf(ctx->saida, "\n");
+    }
+}
 
-void* alocar_memoria(size_t tamanho) {
-    /* Verifica se a nova alocação ultrapassará o limite. */
-    if (memoria_alocada_atual + tamanho > MEMORIA_TOTAL_DISPONIVEL) {
-        fprintf(stderr, "ERRO FATAL: Tentativa de alocação excede a memória máxima. Memória Insuficiente.\n");
-        exit(EXIT_FAILURE);
+/* Lê um inteiro positivo de uma variável de ambiente; 0 se ausente ou inválida. */
+static long ler_inteiro_ambiente(ContextoCompilador* ctx, const char* nome) {
+    const char* valor = getenv(nome);
+    if (valor == NULL) {
+        return 0;
+    }
+    char* fim;
+    long numero = strtol(valor, &fim, 10);
+    if (fim == valor || *fim != '\0' || numero <= 0) {
+        fprintf(ctx->erros, "ALERTA: Valor inválido em %s ('%s'); usando o padrão.\n", nome, valor);
+        return 0;
+    }
+    return numero;
+}
+
+void configurar_orcamento_memoria(ContextoCompilador* ctx, long limite_kb, int percentual_alerta) {
+    if (limite_kb <= 0) {
+        limite_kb = ler_inteiro_ambiente(ctx, "COMPILADOR_MEMORIA_KB");
+    }
+    if (percentual_alerta <= 0) {
+        percentual_alerta = (int) ler_inteiro_ambiente(ctx, "COMPILADOR_ALERTA_MEMORIA");
+    }
+    if (percentual_alerta > 100) {
+        percentual_alerta = 100;
+    }
+    ctx->memoria.limite = (limite_kb > 0 ? limite_kb : MEMORIA_MAXIMA_KB) * 1024;
+    ctx->memoria.percentual_alerta = percentual_alerta > 0 ? percentual_alerta : PERCENTUAL_ALERTA_MEMORIA;
+}
+
+/* Orçamento esgotado: desvia para o ponto de recuperação ou, sem ele, encerra o processo. */
+static void memoria_insuficiente(ContextoCompilador* ctx, const char* motivo, size_t tamanho, CategoriaMemoria categoria) {
+    fprintf(ctx->erros, "ERRO FATAL: %s ao alocar %zu bytes (%s; %ld de %ld KB em uso). Memória Insuficiente.\n",
+            motivo, tamanho, nomes_categorias[categoria], ctx->memoria.alocada_atual / 1024, ctx->memoria.limite / 1024);
+    if (ctx->memoria.recuperacao != NULL) {
+        longjmp(*ctx->memoria.recuperacao, 1);
+    }
+    exit(EXIT_FAILURE);
+}
+
+void* alocar_memoria(ContextoCompilador* ctx, size_t tamanho, CategoriaMemoria categoria) {
+    /* Verifica se a nova alocação ultrapassará o limite rígido. */
+    if (ctx->memoria.alocada_atual + (long) tamanho > ctx->memoria.limite) {
+        memoria_insuficiente(ctx, "Orçamento de memória excedido", tamanho, categoria);
     }
     void* ptr = malloc(tamanho);
     if (ptr == NULL) {
-        fprintf(stderr, "ERRO FATAL: Falha ao alocar memória com malloc. Memória Insuficiente.\n");
-        exit(EXIT_FAILURE);
+        memoria_insuficiente(ctx, "Falha do malloc", tamanho, categoria);
+    }
+    ctx->memoria.alocada_atual += tamanho;
+    if (ctx->memoria.perfil_ativo) {
+        registrar_alocacao(ctx, categoria, tamanho);
     }
-    memoria_alocada_atual += tamanho;
     /* Atualiza o pico de memória, se necessário. */    
-    if (memoria_alocada_atual > memoria_pico_utilizada) {
-        memoria_pico_utilizada = memoria_alocada_atual;
+    if (ctx->memoria.alocada_atual > ctx->memoria.pico_utilizada) {
+        ctx->memoria.pico_utilizada = ctx->memoria.alocada_atual;
     }
-    double percentual_uso = (double)memoria_alocada_atual / MEMORIA_TOTAL_DISPONIVEL;
-    /* Emite um alerta se o uso de memória passar de 90%. */    
-    if (percentual_uso >= 0.9 && percentual_uso < 1.0 && !alerta_memoria_emitido) {
-        printf("ALERTA: Uso de memória atingiu %.2f%% da capacidade total.\n", percentual_uso * 100);
-        alerta_memoria_emitido = 1;
+    double percentual_uso = (double)ctx->memoria.alocada_atual / ctx->memoria.limite;
+    /* Emite um alerta uma vez quando o uso passa do limite brando. */
+    if (percentual_uso * 100 >= ctx->memoria.percentual_alerta && !ctx->memoria.alerta_emitido) {
+        fprintf(ctx->saida, "ALERTA: Uso de memória atingiu %.2f%% da capacidade total.\n", percentual_uso * 100);
+        ctx->memoria.alerta_emitido = 1;
     }
     return ptr;
 }
 
-void liberar_memoria(void* ptr, size_t tamanho) {
+void liberar_memoria(ContextoCompilador* ctx, void* ptr, size_t tamanho, CategoriaMemoria categoria) {
     if (ptr != NULL) {
         free(ptr); /* Libera a memória. */
-        memoria_alocada_atual -= tamanho; /* Decrementa o contador de memória em uso. */
+        ctx->memoria.alocada_atual -= tamanho; /* Decrementa o contador de memória em uso. */
+        if (ctx->memoria.perfil_ativo) {
+            registrar_liberacao(ctx, categoria, tamanho);
+        }
+    }
+}
+
+void exibir_status_memoria(ContextoCompilador* ctx) {
+    fprintf(ctx->saida, "\n------------- RELATÓRIO DE MEMÓRIA -------------\n");
+    fprintf(ctx->saida, "Memória Total Disponivel: %ld KB\n", ctx->memoria.limite / 1024);
+    fprintf(ctx->saida, "Pico de Memória Utilizada: %ld bytes (%.2f KB)\n", ctx->memoria.pico_utilizada, (double)ctx->memoria.pico_utilizada / 1024);
+    fprintf(ctx->saida, "Memória Restante ao Final: %ld bytes\n", ctx->memoria.alocada_atual);
+    for (int i = 0; i < ctx->memoria.total_pools; i++) {
+        PoolObjetos* pool = ctx->memoria.pools[i];
+        if (pool->pico_reservados == 0) continue;
+        fprintf(ctx->saida, "Pool %-16s pico de %d/%d objetos (%.0f%%) de %zu bytes\n", pool->nome,
+               pool->pico_em_uso, pool->pico_reservados,
+               100.0 * pool->pico_em_uso / pool->pico_reservados, pool->tamanho_objeto);
+    }
+    if (ctx->memoria.perfil_ativo) {
+        exibir_perfil_memoria(ctx);
+    }
+    fprintf(ctx->saida, "------------------------------------------------\n");
+}
+
+/* --- ARENA --- */
+
+#define ALINHAMENTO_ARENA 8
+
+void arena_inicializar(ContextoCompilador* ctx, Arena* arena, size_t tamanho_bloco, CategoriaMemoria categoria) {
+    arena->contexto = ctx;
+    arena->atual = NULL;
+    arena->tamanho_bloco = tamanho_bloco;
+    arena->categoria = categoria;
+}
+
+/* Reserva um novo bloco com pelo menos 'minimo' bytes livres. */
+static BlocoArena* arena_novo_bloco(Arena* arena, size_t minimo) {
+    size_t tamanho = minimo > arena->tamanho_bloco ? minimo : arena->tamanho_bloco;
+    BlocoArena* bloco = (BlocoArena*) alocar_memoria(arena->contexto, sizeof(BlocoArena) + tamanho, arena->categoria);
+    bloco->anterior = arena->atual;
+    bloco->tamanho = tamanho;
+    bloco->usado = 0;
+    arena->atual = bloco;
+    return bloco;
+}
+
+void* arena_alocar(Arena* arena, size_t tamanho) {
+    BlocoArena* bloco = arena->atual;
+    size_t inicio = 0;
+    if (bloco != NULL) {
+        inicio = (bloco->usado + ALINHAMENTO_ARENA - 1) & ~(size_t)(ALINHAMENTO_ARENA - 1);
+    }
+    if (bloco == NULL || inicio + tamanho > bloco->tamanho) {
+        bloco = arena_novo_bloco(arena, tamanho);
+        inicio = 0;
+    }
+    bloco->usado = inicio + tamanho;
+    return bloco->dados + inicio;
+}
+
+char* arena_copiar_texto(Arena* arena, const char* texto, size_t tamanho) {
+    /* Texto não precisa de alinhamento: apenas avança o ponteiro do bloco. */
+    BlocoArena* bloco = arena->atual;
+    if (bloco == NULL || bloco->usado + tamanho + 1 > bloco->tamanho) {
+        bloco = arena_novo_bloco(arena, tamanho + 1);
+    }
+    char* copia = bloco->dados + bloco->usado;
+    memcpy(copia, texto, tamanho);
+    copia[tamanho] = '\0';
+    bloco->usado += tamanho + 1;
+    return copia;
+}
+
+void arena_liberar(Arena* arena) {
+    BlocoArena* bloco = arena->atual;
+    while (bloco != NULL) {
+        BlocoArena* anterior = bloco->anterior;
+        liberar_memoria(arena->contexto, bloco, sizeof(BlocoArena) + bloco->tamanho, arena->categoria);
+        bloco = anterior;
+    }
+    arena->atual = NULL;
+}
+
+/* --- REGIÕES POR FASE --- */
+
+/* Tamanho de bloco e categoria de cada região, proporcionais ao que a fase costuma reservar. */
+static const struct {
+    size_t tamanho_bloco;
+    CategoriaMemoria categoria;
+} formato_regioes[TOTAL_REGIOES] = {
+    {4096, CATEGORIA_NOMES},     /* REGIAO_COMPILACAO */
+    {512,  CATEGORIA_TOKENS},    /* REGIAO_LEXICO */
+    {4096, CATEGORIA_SIMBOLOS},  /* REGIAO_SINTATICO */
+    {1024, CATEGORIA_FUNCOES},   /* REGIAO_SEMANTICO */
+    {4096, CATEGORIA_ARVORE}     /* REGIAO_ARVORE */
+};
+
+void* alocar_na_regiao(ContextoCompilador* ctx, RegiaoMemoria regiao, size_t tamanho) {
+    return arena_alocar(&ctx->memoria.regioes[regiao], tamanho);
+}
+
+char* copiar_texto_na_regiao(ContextoCompilador* ctx, RegiaoMemoria regiao, const char* texto, size_t tamanho) {
+    return arena_copiar_texto(&ctx->memoria.regioes[regiao], texto, tamanho);
+}
+
+void liberar_regiao(ContextoCompilador* ctx, RegiaoMemoria regiao) {
+    arena_liberar(&ctx->memoria.regioes[regiao]);
+}
+
+/* --- POOLS DE OBJETOS --- */
+
+void pool_inicializar(ContextoCompilador* ctx, PoolObjetos* pool, const char* nome, size_t tamanho_objeto,
+                      int objetos_por_slab, RegiaoMemoria regiao) {
+    /* Todo objeto precisa comportar o elo da lista de livres e manter o alinhamento. */
+    if (tamanho_objeto < sizeof(ObjetoLivre)) {
+        tamanho_objeto = sizeof(ObjetoLivre);
+    }
+    pool->contexto = ctx;
+    pool->nome = nome;
+    pool->tamanho_objeto = (tamanho_objeto + ALINHAMENTO_ARENA - 1) & ~(size_t)(ALINHAMENTO_ARENA - 1);
+    pool->objetos_por_slab = objetos_por_slab;
+    pool->regiao = regiao;
+    pool->livres = NULL;
+    pool->em_uso = 0;
+    pool->reservados = 0;
+    pool->pico_em_uso = 0;
+    pool->pico_reservados = 0;
+
+    for (int i = 0; i < ctx->memoria.total_pools; i++) {
+        if (ctx->memoria.pools[i] == pool) return;
+    }
+    if (ctx->memoria.total_pools < MAX_POOLS) {
+        ctx->memoria.pools[ctx->memoria.total_pools++] = pool;
+    }
+}
+
+/* Reserva um slab na região do pool e encadeia seus objetos na lista de livres. */
+static void pool_novo_slab(PoolObjetos* pool) {
+    char* slab = (char*) alocar_na_regiao(pool->contexto, pool->regiao, pool->tamanho_objeto * pool->objetos_por_slab);
+    /* Encadeia de trás para frente para que a ordem de entrega siga a ordem na memória. */
+    for (int i = pool->objetos_por_slab - 1; i >= 0; i--) {
+        ObjetoLivre* objeto = (ObjetoLivre*)(slab + pool->tamanho_objeto * i);
+        objeto->proximo = pool->livres;
+        pool->livres = objeto;
+    }
+    pool->reservados += pool->objetos_por_slab;
+    if (pool->reservados > pool->pico_reservados) {
+        pool->pico_reservados = pool->reservados;
+    }
+}
+
+void* pool_alocar(PoolObjetos* pool) {
+    if (pool->livres == NULL) {
+        pool_novo_slab(pool);
+    }
+    ObjetoLivre* objeto = pool->livres;
+    pool->livres = objeto->proximo;
+    if (++pool->em_uso > pool->pico_em_uso) {
+        pool->pico_em_uso = pool->em_uso;
+    }
+    return objeto;
+}
+
+void pool_reiniciar(PoolObjetos* pool) {
+    pool->livres = NULL;
+    pool->em_uso = 0;
+    pool->reservados = 0;
+}
+
+/* --- TABELA DE NOMES --- */
+
+#define CAPACIDADE_INICIAL_NOMES 64
+
+/* Hash FNV-1a de 32 bits. */
+static unsigned int hash_texto(const char* texto, size_t tamanho) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < tamanho; i++) {
+        hash ^= (unsigned char) texto[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void inicializar_tabela_nomes(ContextoCompilador* ctx) {
+    TabelaNomes* tabela = (TabelaNomes*) alocar_na_regiao(ctx, REGIAO_COMPILACAO, sizeof(TabelaNomes));
+    ctx->tabela_nomes = tabela;
+    /* Vetores nulos antes de alocar: destruir_tabela_nomes() funciona mesmo se a memória acabar aqui. */
+    tabela->nomes = NULL;
+    tabela->slots = NULL;
+    tabela->total = 0;
+    tabela->capacidade_nomes = CAPACIDADE_INICIAL_NOMES;
+    tabela->nomes = (EntradaNome*) alocar_memoria(ctx, sizeof(EntradaNome) * CAPACIDADE_INICIAL_NOMES, CATEGORIA_NOMES);
+    tabela->capacidade_slots = CAPACIDADE_INICIAL_NOMES * 2;
+    tabela->slots = (int*) alocar_memoria(ctx, sizeof(int) * tabela->capacidade_slots, CATEGORIA_NOMES);
+    memset(tabela->slots, 0, sizeof(int) * tabela->capacidade_slots);
+}
+
+/* Localiza o slot do nome ou o primeiro slot vazio da sequência de sondagem. */
+static int localizar_slot_nome(const TabelaNomes* tabela, const char* texto, size_t tamanho, unsigned int hash) {
+    int mascara = tabela->capacidade_slots - 1;
+    int slot = (int)(hash & (unsigned int) mascara);
+    while (tabela->slots[slot] != 0) {
+        const EntradaNome* entrada = &tabela->nomes[tabela->slots[slot] - 1];
+        if (entrada->hash == hash && entrada->tamanho == tamanho &&
+            memcmp(entrada->texto, texto, tamanho) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mascara;
     }
+    return slot;
 }
 
-void exibir_status_memoria() {
-    printf("\n------------- RELATÓRIO DE MEMÓRIA -------------\n");
-    printf("Memória Total Disponivel: %ld KB\n", MEMORIA_TOTAL_DISPONIVEL / 1024);
-    printf("Pico de Memória Utilizada: %ld bytes (%.2f KB)\n", memoria_pico_utilizada, (double)memoria_pico_utilizada / 1024);
-    printf("Memória Restante ao Final: %ld bytes\n", memoria_alocada_atual);
-    printf("------------------------------------------------\n");
+/* Dobra a tabela hash e reinsere os ids existentes. */
+static void expandir_slots_nomes(ContextoCompilador* ctx) {
+    TabelaNomes* tabela = ctx->tabela_nomes;
+    /* Aloca a nova tabela antes de soltar a antiga, para que uma falta de memória não a deixe inválida. */
+    int capacidade_antiga = tabela->capacidade_slots;
+    int* novos = (int*) alocar_memoria(ctx, sizeof(int) * capacidade_antiga * 2, CATEGORIA_NOMES);
+    liberar_memoria(ctx, tabela->slots, sizeof(int) * capacidade_antiga, CATEGORIA_NOMES);
+
+    tabela->capacidade_slots = capacidade_antiga * 2;
+    tabela->slots = novos;
+    memset(tabela->slots, 0, sizeof(int) * tabela->capacidade_slots);
+
+    int mascara = tabela->capacidade_slots - 1;
+    for (int id = 0; id < tabela->total; id++) {
+        int slot = (int)(tabela->nomes[id].hash & (unsigned int) mascara);
+        while (tabela->slots[slot] != 0) {
+            slot = (slot + 1) & mascara;
+        }
+        tabela->slots[slot] = id + 1;
+    }
+}
+
+int internar_nome(ContextoCompilador* ctx, const char* texto, size_t tamanho) {
+    TabelaNomes* tabela = ctx->tabela_nomes;
+    unsigned int hash = hash_texto(texto, tamanho);
+    int slot = localizar_slot_nome(tabela, texto, tamanho, hash);
+    if (tabela->slots[slot] != 0) {
+        return tabela->slots[slot] - 1;
+    }
+
+    if (tabela->total == tabela->capacidade_nomes) {
+        int nova_capacidade = tabela->capacidade_nomes * 2;
+        EntradaNome* novos = (EntradaNome*) alocar_memoria(ctx, sizeof(EntradaNome) * nova_capacidade, CATEGORIA_NOMES);
+        memcpy(novos, tabela->nomes, sizeof(EntradaNome) * tabela->total);
+        liberar_memoria(ctx, tabela->nomes, sizeof(EntradaNome) * tabela->capacidade_nomes, CATEGORIA_NOMES);
+        tabela->nomes = novos;
+        tabela->capacidade_nomes = nova_capacidade;
+    }
+
+    int id = tabela->total++;
+    EntradaNome* entrada = &tabela->nomes[id];
+    entrada->texto = copiar_texto_na_regiao(ctx, REGIAO_COMPILACAO, texto, tamanho);
+    entrada->tamanho = tamanho;
+    entrada->hash = hash;
+    tabela->slots[slot] = id + 1;
+
+    /* Mantém o fator de carga abaixo de 50% para sondagens curtas. */
+    if (tabela->total * 2 > tabela->capacidade_slots) {
+        expandir_slots_nomes(ctx);
+    }
+    return id;
+}
+
+int buscar_id_nome(ContextoCompilador* ctx, const char* texto, size_t tamanho) {
+    int slot = localizar_slot_nome(ctx->tabela_nomes, texto, tamanho, hash_texto(texto, tamanho));
+    return ctx->tabela_nomes->slots[slot] - 1;
+}
+
+const char* nome_por_id(ContextoCompilador* ctx, int id) {
+    return ctx->tabela_nomes->nomes[id].texto;
+}
+
+void destruir_tabela_nomes(ContextoCompilador* ctx) {
+    TabelaNomes* tabela = ctx->tabela_nomes;
+    if (tabela) {
+        liberar_memoria(ctx, tabela->slots, sizeof(int) * tabela->capacidade_slots, CATEGORIA_NOMES);
+        liberar_memoria(ctx, tabela->nomes, sizeof(EntradaNome) * tabela->capacidade_nomes, CATEGORIA_NOMES);
+        /* A estrutura e todas as cópias canônicas saem juntas com a região. */
+        liberar_regiao(ctx, REGIAO_COMPILACAO);
+        ctx->tabela_nomes = NULL;
+    }
 }
 
 /* --- ANALISADOR LÉXICO --- */
 
-FILE* arquivo_fonte;
-int linha_atual = 1;
+/*
+ * Nenhum lexema passa disto: a varredura de nomes, números e textos para aqui
+ * e o restante começa outro token (não há erro de "lexema longo demais").
+ */
+#define TAMANHO_MAXIMO_LEXEMA 255
+
+int abrir_fonte(ContextoCompilador* ctx, const char* caminho) {
+    FonteBuffer* fonte = &ctx->fonte;
+    fonte->dados = NULL;
+    fonte->tamanho = 0;
+    fonte->posicao = 0;
+    fonte->mapeado = 0;
+
+#ifdef FONTE_USA_MMAP
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        int erro = errno;
+        close(fd);
+        errno = erro;
+        return 0;
+    }
+
+    /* mmap não aceita tamanho zero: um arquivo vazio fica com buffer vazio. */
+    if (info.st_size > 0) {
+        void* mapa = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapa == MAP_FAILED) {
+            int erro = errno;
+            close(fd);
+            errno = erro;
+            return 0;
+        }
+        fonte->dados = (const char*) mapa;
+        fonte->tamanho = (size_t) info.st_size;
+        fonte->mapeado = 1;
+    }
+    close(fd);
+#else
+    FILE* arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) return 0;
+
+    fseek(arquivo, 0, SEEK_END);
+    long tamanho = ftell(arquivo);
+    fseek(arquivo, 0, SEEK_SET);
+
+    if (tamanho > 0) {
+        char* dados = (char*) malloc((size_t) tamanho);
+        if (dados == NULL) {
+            fclose(arquivo);
+            errno = ENOMEM;
+            return 0;
+        }
+        /* Lê o arquivo inteiro com uma única chamada. */
+        fonte->tamanho = fread(dados, 1, (size_t) tamanho, arquivo);
+        fonte->dados = dados;
+    }
+    fclose(arquivo);
+#endif
+
+    return 1;
+}
+
+void fechar_fonte(ContextoCompilador* ctx) {
+    FonteBuffer* fonte = &ctx->fonte;
+    if (fonte->dados != NULL) {
+#ifdef FONTE_USA_MMAP
+        if (fonte->mapeado) {
+            munmap((void*) fonte->dados, fonte->tamanho);
+        }
+#else
+        free((void*) fonte->dados);
+#endif
+    }
+    fonte->dados = NULL;
+    fonte->tamanho = 0;
+    fonte->posicao = 0;
+    fonte->mapeado = 0;
+}
 
 /* Retorna a string correspondente a um tipo de token. */
 const char* tipo_token_para_str(TipoToken tipo) {
@@ -111,213 +566,880 @@ const char* tipo_token_para_str(TipoToken tipo) {
     }
 }
 
-Token criar_token(TipoToken tipo, char* lexema, int linha) {
+Token criar_token(TipoToken tipo, const char* lexema, int linha, int coluna) {
     Token token;
     token.tipo = tipo;
+    token.lexema = lexema;
     token.linha = linha;
-    size_t len = strlen(lexema) + 1;
-    token.lexema = (char*) alocar_memoria(len); /* Usa a função de alocação segura. */
-    strncpy(token.lexema, lexema, len);
+    token.coluna = coluna;
+    token.id_nome = -1;
+    return token;
+}
+
+Token criar_token_nome(ContextoCompilador* ctx, TipoToken tipo, const char* texto, size_t tamanho, int linha, int coluna) {
+    int id = internar_nome(ctx, texto, tamanho);
+    Token token = criar_token(tipo, nome_por_id(ctx, id), linha, coluna);
+    token.id_nome = id;
     return token;
 }
 
-void destruir_token(Token token) {
-    if (token.lexema) {
-        liberar_memoria(token.lexema, strlen(token.lexema) + 1); /* Usa a função de liberação segura. */
+/*
+ * Classes de caracteres da linguagem, em uma tabela estática de 256 entradas.
+ * Cada byte é classificado com um único acesso à memória, sem depender do
+ * locale do processo (bytes >= 0x80 não pertencem a nenhuma classe).
+ */
+#define CLASSE_ESPACO        0x01
+#define CLASSE_DIGITO        0x02
+#define CLASSE_MINUSCULA     0x04
+#define CLASSE_LETRA         0x08
+#define CLASSE_IDENTIFICADOR 0x10 /* Letras, dígitos e '_': continuação de nomes. */
+#define CLASSE_ALFANUMERICO  0x20
+#define CLASSE_OPERADOR      0x40 /* Início de operador, pontuação ou literal de texto. */
+#define CLASSE_IMPRIMIVEL    0x80
+
+#define ESP (CLASSE_ESPACO)
+#define ESI (CLASSE_ESPACO | CLASSE_IMPRIMIVEL)
+#define DIG (CLASSE_DIGITO | CLASSE_IDENTIFICADOR | CLASSE_ALFANUMERICO | CLASSE_IMPRIMIVEL)
+#define MIN (CLASSE_MINUSCULA | CLASSE_LETRA | CLASSE_IDENTIFICADOR | CLASSE_ALFANUMERICO | CLASSE_IMPRIMIVEL)
+#define MAI (CLASSE_LETRA | CLASSE_IDENTIFICADOR | CLASSE_ALFANUMERICO | CLASSE_IMPRIMIVEL)
+#define SUB (CLASSE_IDENTIFICADOR | CLASSE_IMPRIMIVEL)
+#define OPR (CLASSE_OPERADOR | CLASSE_IMPRIMIVEL)
+#define IMP (CLASSE_IMPRIMIVEL)
+
+static const unsigned char classe_caractere[256] = {
+    /* 0x00 */   0,   0,   0,   0,   0,   0,   0,   0,   0, ESP, ESP, ESP, ESP, ESP,   0,   0,
+    /* 0x10 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /* 0x20 */ ESI, IMP, OPR, IMP, IMP, IMP, OPR, IMP, OPR, OPR, OPR, OPR, OPR, OPR, OPR, OPR,
+    /* 0x30 */ DIG, DIG, DIG, DIG, DIG, DIG, DIG, DIG, DIG, DIG, IMP, OPR, OPR, OPR, OPR, IMP,
+    /* 0x40 */ IMP, MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI,
+    /* 0x50 */ MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI, MAI, OPR, IMP, OPR, OPR, SUB,
+    /* 0x60 */ IMP, MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN,
+    /* 0x70 */ MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN, MIN, OPR, OPR, OPR, IMP,   0,
+    /* 0x80 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /* 0x90 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /* 0xA0 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /* 0xB0 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /* 0xC0 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /* 0xD0 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /* 0xE0 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    /* 0xF0 */   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0
+};
+
+#undef ESP
+#undef ESI
+#undef DIG
+#undef MIN
+#undef MAI
+#undef SUB
+#undef OPR
+#undef IMP
+
+/* EOF (-1) é convertido em 0xFF, que não tem classe. */
+#define TEM_CLASSE(c, classe) (classe_caractere[(unsigned char)(c)] & (classe))
+
+/* --- VARREDURA VETORIZADA --- */
+
+/*
+ * As três varreduras longas do analisador léxico (espaços em branco, corpo de
+ * identificadores e corpo de literais de texto) têm uma versão escalar e, em
+ * x86 com GCC/Clang, versões SSE2 e AVX2. A versão é escolhida em tempo de
+ * execução por selecionar_kernels_varredura() quando o contexto é criado; a
+ * variável de ambiente COMPILADOR_SIMD (escalar, sse2 ou avx2) permite forçar
+ * uma delas; outro valor gera um alerta e mantém a escolha automática. As
+ * tabelas são constantes e compartilhadas entre contextos.
+ */
+
+typedef struct KernelsVarredura {
+    /* Retorna quantos bytes iniciais são espaço em branco. */
+    size_t (*pular_espacos)(const char* p, size_t n);
+    /* Retorna quantos bytes iniciais são letras, dígitos ou '_'. */
+    size_t (*varrer_identificador)(const char* p, size_t n);
+    /* Retorna o índice do primeiro '"' ou '\n' (ou n se não houver). */
+    size_t (*procurar_fim_texto)(const char* p, size_t n);
+    const char* nome;
+} KernelsVarredura;
+
+static size_t pular_espacos_escalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && TEM_CLASSE(p[i], CLASSE_ESPACO)) i++;
+    return i;
+}
+
+static size_t varrer_identificador_escalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && TEM_CLASSE(p[i], CLASSE_IDENTIFICADOR)) i++;
+    return i;
+}
+
+static size_t procurar_fim_texto_escalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && p[i] != '"' && p[i] != '\n') i++;
+    return i;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VARREDURA_X86 1
+#include <immintrin.h>
+
+/*
+ * Comparações de intervalo usam comparação com sinal: bytes >= 0x80 são
+ * negativos e nunca caem nos intervalos ASCII testados, como na tabela escalar.
+ */
+
+__attribute__((target("sse2")))
+static size_t pular_espacos_sse2(const char* p, size_t n) {
+    const __m128i espaco = _mm_set1_epi8(' ');
+    const __m128i tab_menos_1 = _mm_set1_epi8('\t' - 1);
+    const __m128i cr_mais_1 = _mm_set1_epi8('\r' + 1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        __m128i controle = _mm_and_si128(_mm_cmpgt_epi8(v, tab_menos_1), _mm_cmpgt_epi8(cr_mais_1, v));
+        unsigned int branco = (unsigned int) _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, espaco), controle));
+        if (branco != 0xFFFFu) {
+            return i + (size_t) __builtin_ctz(~branco);
+        }
+    }
+    return i + pular_espacos_escalar(p + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static unsigned int mascara_identificador_sse2(__m128i v) {
+    __m128i minuscula = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), v));
+    __m128i maiuscula = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), v));
+    __m128i digito = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), v));
+    __m128i sublinhado = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return (unsigned int) _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(minuscula, maiuscula), _mm_or_si128(digito, sublinhado)));
+}
+
+__attribute__((target("sse2")))
+static size_t varrer_identificador_sse2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        unsigned int mascara = mascara_identificador_sse2(_mm_loadu_si128((const __m128i*)(p + i)));
+        if (mascara != 0xFFFFu) {
+            return i + (size_t) __builtin_ctz(~mascara);
+        }
+    }
+    return i + varrer_identificador_escalar(p + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static size_t procurar_fim_texto_sse2(const char* p, size_t n) {
+    const __m128i aspa = _mm_set1_epi8('"');
+    const __m128i quebra = _mm_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        unsigned int mascara = (unsigned int) _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, aspa), _mm_cmpeq_epi8(v, quebra)));
+        if (mascara != 0) {
+            return i + (size_t) __builtin_ctz(mascara);
+        }
+    }
+    return i + procurar_fim_texto_escalar(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t pular_espacos_avx2(const char* p, size_t n) {
+    const __m256i espaco = _mm256_set1_epi8(' ');
+    const __m256i tab_menos_1 = _mm256_set1_epi8('\t' - 1);
+    const __m256i cr_mais_1 = _mm256_set1_epi8('\r' + 1);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+        __m256i controle = _mm256_and_si256(_mm256_cmpgt_epi8(v, tab_menos_1), _mm256_cmpgt_epi8(cr_mais_1, v));
+        unsigned int branco = (unsigned int) _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, espaco), controle));
+        if (branco != 0xFFFFFFFFu) {
+            return i + (size_t) __builtin_ctz(~branco);
+        }
+    }
+    return i + pular_espacos_sse2(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static size_t varrer_identificador_avx2(const char* p, size_t n) {
+    const __m256i a_menos_1 = _mm256_set1_epi8('a' - 1), z_mais_1 = _mm256_set1_epi8('z' + 1);
+    const __m256i A_menos_1 = _mm256_set1_epi8('A' - 1), Z_mais_1 = _mm256_set1_epi8('Z' + 1);
+    const __m256i zero_menos_1 = _mm256_set1_epi8('0' - 1), nove_mais_1 = _mm256_set1_epi8('9' + 1);
+    const __m256i sublinhado = _mm256_set1_epi8('_');
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+        __m256i minuscula = _mm256_and_si256(_mm256_cmpgt_epi8(v, a_menos_1), _mm256_cmpgt_epi8(z_mais_1, v));
+        __m256i maiuscula = _mm256_and_si256(_mm256_cmpgt_epi8(v, A_menos_1), _mm256_cmpgt_epi8(Z_mais_1, v));
+        __m256i digito = _mm256_and_si256(_mm256_cmpgt_epi8(v, zero_menos_1), _mm256_cmpgt_epi8(nove_mais_1, v));
+        __m256i valido = _mm256_or_si256(_mm256_or_si256(minuscula, maiuscula),
+                                         _mm256_or_si256(digito, _mm256_cmpeq_epi8(v, sublinhado)));
+        unsigned int mascara = (unsigned int) _mm256_movemask_epi8(valido);
+        if (mascara != 0xFFFFFFFFu) {
+            return i + (size_t) __builtin_ctz(~mascara);
+        }
     }
+    return i + varrer_identificador_sse2(p + i, n - i);
 }
-/* Funções auxiliares para ler caracteres do arquivo. */
-int proximo_char() {
-    int c = fgetc(arquivo_fonte);
-    if (c == '\n') {
-        linha_atual++;
+
+__attribute__((target("avx2")))
+static size_t procurar_fim_texto_avx2(const char* p, size_t n) {
+    const __m256i aspa = _mm256_set1_epi8('"');
+    const __m256i quebra = _mm256_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+        unsigned int mascara = (unsigned int) _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, aspa), _mm256_cmpeq_epi8(v, quebra)));
+        if (mascara != 0) {
+            return i + (size_t) __builtin_ctz(mascara);
+        }
     }
-    return c;
+    return i + procurar_fim_texto_sse2(p + i, n - i);
 }
+#endif
+
+static const KernelsVarredura kernels_escalar = {
+    pular_espacos_escalar, varrer_identificador_escalar, procurar_fim_texto_escalar, "escalar"
+};
+
+#ifdef VARREDURA_X86
+static const KernelsVarredura kernels_sse2 = {
+    pular_espacos_sse2, varrer_identificador_sse2, procurar_fim_texto_sse2, "sse2"
+};
+
+static const KernelsVarredura kernels_avx2 = {
+    pular_espacos_avx2, varrer_identificador_avx2, procurar_fim_texto_avx2, "avx2"
+};
+#endif
 
-void devolver_char(int c) {
-    if (c == '\n') {
-        linha_atual--;
+static const KernelsVarredura* selecionar_kernels_varredura(ContextoCompilador* ctx) {
+    const char* forcado = getenv("COMPILADOR_SIMD");
+    if (forcado != NULL && strcmp(forcado, "escalar") != 0 && strcmp(forcado, "sse2") != 0 && strcmp(forcado, "avx2") != 0) {
+        fprintf(ctx->erros, "ALERTA: Valor inválido em COMPILADOR_SIMD ('%s'); usando o padrão.\n", forcado);
+        forcado = NULL;
     }
-    ungetc(c, arquivo_fonte);
+#ifdef VARREDURA_X86
+    __builtin_cpu_init();
+    if (forcado != NULL && strcmp(forcado, "escalar") == 0) {
+        return &kernels_escalar;
+    }
+    if (__builtin_cpu_supports("avx2") && (forcado == NULL || strcmp(forcado, "avx2") == 0)) {
+        return &kernels_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return &kernels_sse2;
+    }
+#else
+    (void) forcado;
+#endif
+    return &kernels_escalar;
+}
+
+/* Funções auxiliares para ler caracteres do buffer do código-fonte. */
+static int proximo_char(FonteBuffer* fonte) {
+    if (fonte->posicao >= fonte->tamanho) {
+        return EOF;
+    }
+    return (unsigned char) fonte->dados[fonte->posicao++];
+}
+
+/* Consulta o próximo caractere sem avançar (substitui o antigo ungetc). */
+static int espiar_char(const FonteBuffer* fonte) {
+    if (fonte->posicao >= fonte->tamanho) {
+        return EOF;
+    }
+    return (unsigned char) fonte->dados[fonte->posicao];
+}
+
+/* Avança um caractere se ele for o esperado. */
+static int consumir_char_se(FonteBuffer* fonte, int esperado) {
+    if (espiar_char(fonte) == esperado) {
+        fonte->posicao++;
+        return 1;
+    }
+    return 0;
+}
+
+/* Palavras reservadas, na mesma ordem de TipoToken (TOKEN_PRINCIPAL..TOKEN_DECIMAL). */
+static const char* const palavras_reservadas[] = {
+    "principal", "funcao", "retorno", "leia", "escreva", "se", "senao", "para",
+    "inteiro", "texto", "decimal"
+};
+
+/*
+ * Verifica se um trecho do código-fonte é uma palavra reservada.
+ *
+ * O tamanho e o primeiro caractere já identificam no máximo uma candidata
+ * (o conjunto não tem colisões nesse par), então basta um memcmp.
+ */
+static TipoToken verificar_palavra_reservada(const char* texto, size_t tamanho) {
+    TipoToken candidata;
+    switch (tamanho) {
+        case 2: candidata = TOKEN_SE; break;
+        case 4:
+            if (texto[0] == 'l') candidata = TOKEN_LEIA;
+            else if (texto[0] == 'p') candidata = TOKEN_PARA;
+            else return TOKEN_ERRO;
+            break;
+        case 5:
+            if (texto[0] == 't') candidata = TOKEN_TEXTO;
+            else if (texto[0] == 's') candidata = TOKEN_SENAO;
+            else return TOKEN_ERRO;
+            break;
+        case 6: candidata = TOKEN_FUNCAO; break;
+        case 7:
+            switch (texto[0]) {
+                case 'i': candidata = TOKEN_INTEIRO; break;
+                case 'd': candidata = TOKEN_DECIMAL; break;
+                case 'e': candidata = TOKEN_ESCREVA; break;
+                case 'r': candidata = TOKEN_RETORNO; break;
+                default: return TOKEN_ERRO;
+            }
+            break;
+        case 9: candidata = TOKEN_PRINCIPAL; break;
+        default: return TOKEN_ERRO;
+    }
+    return memcmp(texto, palavras_reservadas[candidata], tamanho) == 0 ? candidata : TOKEN_ERRO;
+}
+
+/* Quantos bytes ainda podem entrar no lexema iniciado em 'inicio' sem passar do fim do buffer. */
+static size_t restante_lexema(const FonteBuffer* fonte, size_t inicio) {
+    size_t restante_buffer = fonte->tamanho - fonte->posicao;
+    size_t restante_limite = TAMANHO_MAXIMO_LEXEMA - (fonte->posicao - inicio);
+    return restante_buffer < restante_limite ? restante_buffer : restante_limite;
+}
+
+static TokenBruto token_bruto(TipoToken tipo, size_t inicio, size_t tamanho) {
+    TokenBruto token;
+    token.tipo = tipo;
+    token.inicio = (unsigned int) inicio;
+    token.tamanho = (unsigned int) tamanho;
+    return token;
 }
 
-/* Verifica se uma string é uma palavra reservada. */
-TipoToken verificar_palavra_reservada(const char* str) {
-    if (strcmp(str, "principal") == 0) return TOKEN_PRINCIPAL;
-    if (strcmp(str, "funcao") == 0) return TOKEN_FUNCAO;
-    if (strcmp(str, "retorno") == 0) return TOKEN_RETORNO;
-    if (strcmp(str, "leia") == 0) return TOKEN_LEIA;
-    if (strcmp(str, "escreva") == 0) return TOKEN_ESCREVA;
-    if (strcmp(str, "se") == 0) return TOKEN_SE;
-    if (strcmp(str, "senao") == 0) return TOKEN_SENAO;
-    if (strcmp(str, "para") == 0) return TOKEN_PARA;
-    if (strcmp(str, "inteiro") == 0) return TOKEN_INTEIRO;
-    if (strcmp(str, "texto") == 0) return TOKEN_TEXTO;
-    if (strcmp(str, "decimal") == 0) return TOKEN_DECIMAL;
-    return TOKEN_ERRO;
+/* Token cujo lexema vai de 'inicio' até a posição atual do buffer. */
+static TokenBruto token_ate_aqui(const FonteBuffer* fonte, TipoToken tipo, size_t inicio) {
+    return token_bruto(tipo, inicio, fonte->posicao - inicio);
 }
 
-/* Função principal do analisador léxico. */
-Token obter_proximo_token() {
+/*
+ * Função principal do analisador léxico. Lê de 'fonte', que pode ser apenas um
+ * trecho de ctx->fonte, e escreve a mensagem do token de erro em 'mensagem_erro'
+ * (TAMANHO_MENSAGEM_ERRO_LEXICO bytes). Do contexto só lê os kernels e o índice
+ * de linhas, então várias threads podem varrer trechos distintos ao mesmo tempo.
+ */
+static TokenBruto varrer_token(ContextoCompilador* ctx, FonteBuffer* fonte, char* mensagem_erro) {
+    const struct KernelsVarredura* varredura = ctx->varredura;
     int c;
-    char buffer[256];
-    int i = 0;
+    int linha, coluna; /* Só calculadas nos caminhos de erro, a partir do índice de linhas. */
+
+    /* Pula espaços em branco de uma vez; as linhas vêm do índice de linhas, não de contagem aqui. */
+    fonte->posicao += varredura->pular_espacos(fonte->dados + fonte->posicao, fonte->tamanho - fonte->posicao);
+    if ((c = proximo_char(fonte)) == EOF) {
+        return token_bruto(TOKEN_FIM_DE_ARQUIVO, fonte->tamanho, 0);
+    }
 
-    while ((c = proximo_char()) != EOF) {
-        if (isspace(c)) continue;
+    /* O lexema é uma fatia do buffer do código-fonte: nada é copiado aqui. */
+    size_t inicio = fonte->posicao - 1;
 
-        /* --- Tratamento de Símbolos Simples e Compostos --- */
+    /* --- Tratamento de Símbolos Simples e Compostos --- */
+    if (TEM_CLASSE(c, CLASSE_OPERADOR)) {
         switch (c) {
-            case '+':
-                if ((c = proximo_char()) == '+') return criar_token(TOKEN_INCREMENT, "++", linha_atual);
-                else { devolver_char(c); return criar_token(TOKEN_OP_SOMA, "+", linha_atual); }
-            case '-':
-                if ((c = proximo_char()) == '-') return criar_token(TOKEN_DECREMENT, "--", linha_atual);
-                else { devolver_char(c); return criar_token(TOKEN_OP_SUBTRACAO, "-", linha_atual); }
-            case '*': return criar_token(TOKEN_OP_MULTIPLICACAO, "*", linha_atual);
-            case '/': return criar_token(TOKEN_OP_DIVISAO, "/", linha_atual);
-            case '^': return criar_token(TOKEN_OP_EXPONENCIACAO, "^", linha_atual);
-            case '(': return criar_token(TOKEN_PARENTESES_ESQ, "(", linha_atual);
-            case ')': return criar_token(TOKEN_PARENTESES_DIR, ")", linha_atual);
-            case '{': return criar_token(TOKEN_CHAVES_ESQ, "{", linha_atual);
-            case '}': return criar_token(TOKEN_CHAVES_DIR, "}", linha_atual);
-            case '[': return criar_token(TOKEN_COLCHETES_ESQ, "[", linha_atual);
-            case ']': return criar_token(TOKEN_COLCHETES_DIR, "]", linha_atual);
-            case ';': return criar_token(TOKEN_PONTO_VIRGULA, ";", linha_atual);
-            case ',': return criar_token(TOKEN_VIRGULA, ",", linha_atual);
-            case '.': return criar_token(TOKEN_PONTO, ".", linha_atual);
-            case '=':
-                if ((c = proximo_char()) == '=') return criar_token(TOKEN_OP_IGUAL, "==", linha_atual);
-                else { devolver_char(c); return criar_token(TOKEN_ATRIBUICAO, "=", linha_atual); }
+            case '+': return token_ate_aqui(fonte, consumir_char_se(fonte, '+') ? TOKEN_INCREMENT : TOKEN_OP_SOMA, inicio);
+            case '-': return token_ate_aqui(fonte, consumir_char_se(fonte, '-') ? TOKEN_DECREMENT : TOKEN_OP_SUBTRACAO, inicio);
+            case '*': return token_ate_aqui(fonte, TOKEN_OP_MULTIPLICACAO, inicio);
+            case '/': return token_ate_aqui(fonte, TOKEN_OP_DIVISAO, inicio);
+            case '^': return token_ate_aqui(fonte, TOKEN_OP_EXPONENCIACAO, inicio);
+            case '(': return token_ate_aqui(fonte, TOKEN_PARENTESES_ESQ, inicio);
+            case ')': return token_ate_aqui(fonte, TOKEN_PARENTESES_DIR, inicio);
+            case '{': return token_ate_aqui(fonte, TOKEN_CHAVES_ESQ, inicio);
+            case '}': return token_ate_aqui(fonte, TOKEN_CHAVES_DIR, inicio);
+            case '[': return token_ate_aqui(fonte, TOKEN_COLCHETES_ESQ, inicio);
+            case ']': return token_ate_aqui(fonte, TOKEN_COLCHETES_DIR, inicio);
+            case ';': return token_ate_aqui(fonte, TOKEN_PONTO_VIRGULA, inicio);
+            case ',': return token_ate_aqui(fonte, TOKEN_VIRGULA, inicio);
+            case '.': return token_ate_aqui(fonte, TOKEN_PONTO, inicio);
+            case '=': return token_ate_aqui(fonte, consumir_char_se(fonte, '=') ? TOKEN_OP_IGUAL : TOKEN_ATRIBUICAO, inicio);
             case '<':
-                c = proximo_char();
-                if (c == '=') return criar_token(TOKEN_OP_MENOR_IGUAL, "<=", linha_atual);
-                else if (c == '>') return criar_token(TOKEN_OP_DIFERENTE, "<>", linha_atual);
-                else { devolver_char(c); return criar_token(TOKEN_OP_MENOR, "<", linha_atual); }
-            case '>':
-                if ((c = proximo_char()) == '=') return criar_token(TOKEN_OP_MAIOR_IGUAL, ">=", linha_atual);
-                else { devolver_char(c); return criar_token(TOKEN_OP_MAIOR, ">", linha_atual); }
+                if (consumir_char_se(fonte, '=')) return token_ate_aqui(fonte, TOKEN_OP_MENOR_IGUAL, inicio);
+                if (consumir_char_se(fonte, '>')) return token_ate_aqui(fonte, TOKEN_OP_DIFERENTE, inicio);
+                return token_ate_aqui(fonte, TOKEN_OP_MENOR, inicio);
+            case '>': return token_ate_aqui(fonte, consumir_char_se(fonte, '=') ? TOKEN_OP_MAIOR_IGUAL : TOKEN_OP_MAIOR, inicio);
             case '&':
-                if ((c = proximo_char()) == '&') return criar_token(TOKEN_OP_E, "&&", linha_atual);
-                else {
-                    devolver_char(c);
-                    sprintf(buffer, "Caractere inesperado: '&' na linha %d", linha_atual);
-                    return criar_token(TOKEN_ERRO, buffer, linha_atual);
-                }
+                if (consumir_char_se(fonte, '&')) return token_ate_aqui(fonte, TOKEN_OP_E, inicio);
+                posicao_do_deslocamento(ctx, (unsigned int) inicio, &linha, &coluna);
+                snprintf(mensagem_erro, TAMANHO_MENSAGEM_ERRO_LEXICO, "Caractere inesperado: '&' na linha %d, coluna %d", linha, coluna);
+                return token_ate_aqui(fonte, TOKEN_ERRO, inicio);
             case '|':
-                if ((c = proximo_char()) == '|') return criar_token(TOKEN_OP_OU, "||", linha_atual);
-                else {
-                    devolver_char(c);
-                    sprintf(buffer, "Caractere inesperado: '|' na linha %d", linha_atual);
-                    return criar_token(TOKEN_ERRO, buffer, linha_atual);
-                }
-            /* --- Tratamento de Literais de Texto --- */    
-                /* --- Tratamento de Literais de Texto --- */
-            case '"':
-                i = 0;
-                int linha_inicio_string = linha_atual;
-                // Adicionamos a condição c != '\n' para parar a leitura na quebra de linha
-                while((c = proximo_char()) != '"' && c != '\n' && c != EOF && i < 255) {
-                    buffer[i++] = c;
-                }
+                if (consumir_char_se(fonte, '|')) return token_ate_aqui(fonte, TOKEN_OP_OU, inicio);
+                posicao_do_deslocamento(ctx, (unsigned int) inicio, &linha, &coluna);
+                snprintf(mensagem_erro, TAMANHO_MENSAGEM_ERRO_LEXICO, "Caractere inesperado: '|' na linha %d, coluna %d", linha, coluna);
+                return token_ate_aqui(fonte, TOKEN_ERRO, inicio);
+            /* --- Tratamento de Literais de Texto --- */
+            case '"': {
+                size_t inicio_conteudo = fonte->posicao;
+                // A leitura para na quebra de linha, que fica no buffer para a próxima chamada
+                fonte->posicao += varredura->procurar_fim_texto(fonte->dados + fonte->posicao, restante_lexema(fonte, inicio_conteudo));
+                c = espiar_char(fonte);
 
                 // Se o laço parou por quebra de linha ou fim de arquivo, a string não foi fechada.
                 if (c == '\n' || c == EOF) {
-                    if (c == '\n') {
-                        devolver_char(c); // Devolve o '\n' para não afetar a contagem da próxima linha.
-                    }
-                    sprintf(buffer, "ERRO LÉXICO: String literal iniciada na linha %d não foi fechada na mesma linha.", linha_inicio_string);
-                    return criar_token(TOKEN_ERRO, buffer, linha_inicio_string);
+                    posicao_do_deslocamento(ctx, (unsigned int) inicio, &linha, &coluna);
+                    snprintf(mensagem_erro, TAMANHO_MENSAGEM_ERRO_LEXICO, "ERRO LÉXICO: String literal iniciada na linha %d, coluna %d não foi fechada na mesma linha.", linha, coluna);
+                    return token_ate_aqui(fonte, TOKEN_ERRO, inicio);
                 }
 
-                buffer[i] = '\0';
-                return criar_token(TOKEN_LITERAL_TEXTO, buffer, linha_atual);
-            default: ;
-        }
-        /* --- Tratamento de Identificadores de Variáveis (começam com '!') --- */
-        if (c == '!') {
-            i = 0;
-            buffer[i++] = c;
-            c = proximo_char();
-            if (!islower(c)) {
-                sprintf(buffer, "Nome de variável inválido na linha %d. Esperado a-z após '!'.", linha_atual);
-                return criar_token(TOKEN_ERRO, buffer, linha_atual);
+                /* O lexema guardado é apenas o conteúdo entre as aspas. */
+                TokenBruto token = token_ate_aqui(fonte, TOKEN_LITERAL_TEXTO, inicio_conteudo);
+                if (c == '"') {
+                    fonte->posicao++; /* Consome a aspa de fechamento. */
+                }
+                return token;
             }
-            buffer[i++] = c;
-            while ((isalnum(c = proximo_char()) || c == '_') && i < 255) buffer[i++] = c;
-            devolver_char(c);
-            buffer[i] = '\0';
-            return criar_token(TOKEN_ID_VARIAVEL, buffer, linha_atual);
         }
-        /* --- Tratamento de Literais Numéricos --- */
-        if (isdigit(c)) {
-            i = 0;
-            int tem_ponto = 0;
-            buffer[i++] = c;
-            while ((isdigit(c = proximo_char()) || c == '.') && i < 255) {
-                if (c == '.') {
-                    if (tem_ponto) break;
-                    tem_ponto = 1;
-                }
-                buffer[i++] = c;
+    }
+
+    /* --- Tratamento de Identificadores de Variáveis (começam com '!') --- */
+    if (c == '!') {
+        if (!TEM_CLASSE(espiar_char(fonte), CLASSE_MINUSCULA)) {
+            posicao_do_deslocamento(ctx, (unsigned int) inicio, &linha, &coluna);
+            snprintf(mensagem_erro, TAMANHO_MENSAGEM_ERRO_LEXICO, "Nome de variável inválido na linha %d, coluna %d. Esperado a-z após '!'.", linha, coluna);
+            return token_ate_aqui(fonte, TOKEN_ERRO, inicio);
+        }
+        fonte->posicao += varredura->varrer_identificador(fonte->dados + fonte->posicao, restante_lexema(fonte, inicio));
+        return token_ate_aqui(fonte, TOKEN_ID_VARIAVEL, inicio);
+    }
+    /* --- Tratamento de Literais Numéricos --- */
+    if (TEM_CLASSE(c, CLASSE_DIGITO)) {
+        int tem_ponto = 0;
+        while ((TEM_CLASSE(c = espiar_char(fonte), CLASSE_DIGITO) || c == '.') && fonte->posicao - inicio < TAMANHO_MAXIMO_LEXEMA) {
+            if (c == '.') {
+                if (tem_ponto) break;
+                tem_ponto = 1;
             }
-            devolver_char(c);
-            buffer[i] = '\0';
-            return criar_token(TOKEN_LITERAL_NUMERO, buffer, linha_atual);
+            fonte->posicao++;
         }
-        /* --- Tratamento de Palavras Reservadas e Identificadores de Função (começam com '__') --- */
-        if (isalpha(c) || c == '_') {
-            i = 0;
-            buffer[i++] = c;
-
-            if (c == '_') {
-                if ((c = proximo_char()) == '_') {
-                    buffer[i++] = c;
-                    c = proximo_char();
-                    if (!isalnum(c)) {
-                        sprintf(buffer, "Nome de função inválido na linha %d. Esperado caractere alfanumérico após '__'.", linha_atual);
-                        return criar_token(TOKEN_ERRO, buffer, linha_atual);
-                    }
-                    buffer[i++] = c;
-                    while ((isalnum(c = proximo_char()) || c == '_') && i < 255) {
-                        buffer[i++] = c;
-                    }
-                    devolver_char(c);
-                    buffer[i] = '\0';
-                    return criar_token(TOKEN_ID_FUNCAO, buffer, linha_atual);
-                } else {
-                    devolver_char(c);
-                    sprintf(buffer, "Identificador inválido '_' na linha %d.", linha_atual);
-                    return criar_token(TOKEN_ERRO, buffer, linha_atual);
+        return token_ate_aqui(fonte, TOKEN_LITERAL_NUMERO, inicio);
+    }
+    /* --- Tratamento de Palavras Reservadas e Identificadores de Função (começam com '__') --- */
+    if (TEM_CLASSE(c, CLASSE_IDENTIFICADOR)) {
+        if (c == '_') {
+            if (consumir_char_se(fonte, '_')) {
+                if (!TEM_CLASSE(espiar_char(fonte), CLASSE_ALFANUMERICO)) {
+                    posicao_do_deslocamento(ctx, (unsigned int) inicio, &linha, &coluna);
+                    snprintf(mensagem_erro, TAMANHO_MENSAGEM_ERRO_LEXICO, "Nome de função inválido na linha %d, coluna %d. Esperado caractere alfanumérico após '__'.", linha, coluna);
+                    return token_ate_aqui(fonte, TOKEN_ERRO, inicio);
                 }
+                fonte->posicao += varredura->varrer_identificador(fonte->dados + fonte->posicao, restante_lexema(fonte, inicio));
+                return token_ate_aqui(fonte, TOKEN_ID_FUNCAO, inicio);
+            } else {
+                posicao_do_deslocamento(ctx, (unsigned int) inicio, &linha, &coluna);
+                snprintf(mensagem_erro, TAMANHO_MENSAGEM_ERRO_LEXICO, "Identificador inválido '_' na linha %d, coluna %d.", linha, coluna);
+                return token_ate_aqui(fonte, TOKEN_ERRO, inicio);
             }
+        }
 
-            while ((isalnum(c = proximo_char()) || c == '_') && i < 255) {
-                buffer[i++] = c;
-            }
-            devolver_char(c);
-            buffer[i] = '\0';
+        fonte->posicao += varredura->varrer_identificador(fonte->dados + fonte->posicao, restante_lexema(fonte, inicio));
+        int tamanho = (int)(fonte->posicao - inicio);
+        TipoToken tipo_reservado = verificar_palavra_reservada(fonte->dados + inicio, tamanho);
+        if (tipo_reservado != TOKEN_ERRO) {
+            return token_ate_aqui(fonte, tipo_reservado, inicio);
+        }
 
-            TipoToken tipo_reservado = verificar_palavra_reservada(buffer);
-            if (tipo_reservado != TOKEN_ERRO) {
-                return criar_token(tipo_reservado, buffer, linha_atual);
-            }
+        /* Se nenhum dos casos acima tratar o caractere, é um erro. */
+        posicao_do_deslocamento(ctx, (unsigned int) inicio, &linha, &coluna);
+        snprintf(mensagem_erro, TAMANHO_MENSAGEM_ERRO_LEXICO, "Identificador ou palavra reservada inválida '%.*s' na linha %d, coluna %d.", tamanho, fonte->dados + inicio, linha, coluna);
+        return token_ate_aqui(fonte, TOKEN_ERRO, inicio);
+    }
+
+    posicao_do_deslocamento(ctx, (unsigned int) inicio, &linha, &coluna);
+    if (TEM_CLASSE(c, CLASSE_IMPRIMIVEL)) {
+        snprintf(mensagem_erro, TAMANHO_MENSAGEM_ERRO_LEXICO, "Caractere não reconhecido '%c' na linha %d, coluna %d.", c, linha, coluna);
+    } else {
+        snprintf(mensagem_erro, TAMANHO_MENSAGEM_ERRO_LEXICO, "Caractere não reconhecido (ASCII: %d) na linha %d, coluna %d.", c, linha, coluna);
+    }
+    return token_ate_aqui(fonte, TOKEN_ERRO, inicio);
+}
+
+TokenBruto obter_proximo_token(ContextoCompilador* ctx) {
+    return varrer_token(ctx, &ctx->fonte, ctx->mensagem_erro_lexico);
+}
+
+/* --- FLUXO DE TOKENS --- */
+
+#define CAPACIDADE_INICIAL_TOKENS 256
+/* Estimativa inicial de bytes de código-fonte por token (identificador, espaços e pontuação). */
+#define BYTES_FONTE_POR_TOKEN 4
+#define CAPACIDADE_INICIAL_LINHAS 64
+
+/* Lexemas dos tokens de grafia fixa, indexados por TipoToken (NULL nos de lexema variável). */
+static const char* const lexemas_fixos[] = {
+    "principal", "funcao", "retorno", "leia", "escreva", "se", "senao", "para",
+    "inteiro", "texto", "decimal", NULL, NULL,
+    NULL, NULL, "+", "-",
+    "*", "/", "^", "==",
+    "<>", "<", "<=", ">", ">=",
+    "&&", "||", "=", "++", "--",
+    "(", ")", "{", "}",
+    "[", "]", ";", ",",
+    ".", "EOF", NULL
+};
+
+/* Realoca um vetor paralelo do fluxo preservando os elementos já gravados. */
+static void* realocar_vetor(ContextoCompilador* ctx, void* antigo, size_t tamanho_elemento, int total, int capacidade_antiga, int capacidade_nova) {
+    void* novo = alocar_memoria(ctx, tamanho_elemento * capacidade_nova, CATEGORIA_TOKENS);
+    if (antigo != NULL) {
+        memcpy(novo, antigo, tamanho_elemento * total);
+        liberar_memoria(ctx, antigo, tamanho_elemento * capacidade_antiga, CATEGORIA_TOKENS);
+    }
+    return novo;
+}
+
+#define BYTES_POR_TOKEN (sizeof(unsigned int) + sizeof(unsigned short) + sizeof(unsigned char))
+
+/*
+ * Os três vetores paralelos dividem um único bloco (inícios, tamanhos, tipos,
+ * nessa ordem, para manter o alinhamento). Assim o crescimento é uma só
+ * alocação: se o orçamento se esgotar, o fluxo antigo continua íntegro.
+ */
+static void reservar_vetores_tokens(ContextoCompilador* ctx, int capacidade) {
+    char* bloco = (char*) alocar_memoria(ctx, BYTES_POR_TOKEN * capacidade, CATEGORIA_TOKENS);
+    unsigned int* inicios = (unsigned int*) bloco;
+    unsigned short* tamanhos = (unsigned short*)(inicios + capacidade);
+    unsigned char* tipos = (unsigned char*)(tamanhos + capacidade);
+
+    if (ctx->fluxo_tokens->inicios != NULL) {
+        int total = ctx->fluxo_tokens->total;
+        memcpy(inicios, ctx->fluxo_tokens->inicios, sizeof(unsigned int) * total);
+        memcpy(tamanhos, ctx->fluxo_tokens->tamanhos, sizeof(unsigned short) * total);
+        memcpy(tipos, ctx->fluxo_tokens->tipos, sizeof(unsigned char) * total);
+        liberar_memoria(ctx, ctx->fluxo_tokens->inicios, BYTES_POR_TOKEN * ctx->fluxo_tokens->capacidade, CATEGORIA_TOKENS);
+    }
+    ctx->fluxo_tokens->inicios = inicios;
+    ctx->fluxo_tokens->tamanhos = tamanhos;
+    ctx->fluxo_tokens->tipos = tipos;
+    ctx->fluxo_tokens->capacidade = capacidade;
+}
+
+static void adicionar_token(ContextoCompilador* ctx, TokenBruto token) {
+    if (ctx->fluxo_tokens->total == ctx->fluxo_tokens->capacidade) {
+        /*
+         * Cresce geometricamente para manter a inserção amortizada em O(1). O fator
+         * 1,5 (e não 2) limita o pico da cópia, em que os blocos antigo e novo
+         * coexistem dentro do orçamento.
+         */
+        int capacidade = ctx->fluxo_tokens->capacidade;
+        reservar_vetores_tokens(ctx, capacidade + capacidade / 2);
+    }
+    int i = ctx->fluxo_tokens->total++;
+    ctx->fluxo_tokens->tipos[i] = (unsigned char) token.tipo;
+    ctx->fluxo_tokens->inicios[i] = token.inicio;
+    ctx->fluxo_tokens->tamanhos[i] = (unsigned short) token.tamanho;
+}
 
-            char erro_msg[512];
-            /* Se nenhum dos casos acima tratar o caractere, é um erro. */
-            sprintf(erro_msg, "Identificador ou palavra reservada inválida '%s' na linha %d.", buffer, linha_atual);
-            return criar_token(TOKEN_ERRO, erro_msg, linha_atual);
+/* Registra o deslocamento de início de cada linha do código-fonte. */
+static void indexar_linhas(ContextoCompilador* ctx) {
+    const FonteBuffer* fonte = &ctx->fonte;
+    ctx->fluxo_tokens->inicios_linha = (unsigned int*) alocar_memoria(ctx, sizeof(unsigned int) * CAPACIDADE_INICIAL_LINHAS, CATEGORIA_TOKENS);
+    ctx->fluxo_tokens->capacidade_linhas = CAPACIDADE_INICIAL_LINHAS;
+    ctx->fluxo_tokens->inicios_linha[0] = 0;
+    ctx->fluxo_tokens->total_linhas = 1;
+    ctx->fluxo_tokens->cursor_deslocamento = 0;
+    ctx->fluxo_tokens->cursor_coluna = 1;
+
+    const char* atual = fonte->dados;
+    const char* fim = fonte->dados + fonte->tamanho;
+    while (atual < fim && (atual = (const char*) memchr(atual, '\n', (size_t)(fim - atual))) != NULL) {
+        atual++;
+        if (ctx->fluxo_tokens->total_linhas == ctx->fluxo_tokens->capacidade_linhas) {
+            int nova = ctx->fluxo_tokens->capacidade_linhas * 2;
+            ctx->fluxo_tokens->inicios_linha = (unsigned int*) realocar_vetor(ctx, ctx->fluxo_tokens->inicios_linha, sizeof(unsigned int),
+                                                                         ctx->fluxo_tokens->total_linhas, ctx->fluxo_tokens->capacidade_linhas, nova);
+            ctx->fluxo_tokens->capacidade_linhas = nova;
         }
+        ctx->fluxo_tokens->inicios_linha[ctx->fluxo_tokens->total_linhas++] = (unsigned int)(atual - fonte->dados);
+    }
+}
 
-        char erro_msg[512];
-        if (isprint(c)) {
-            sprintf(erro_msg, "Caractere não reconhecido '%c' na linha %d.", c, linha_atual);
+int linha_do_deslocamento(ContextoCompilador* ctx, unsigned int deslocamento) {
+    /* Busca binária pela última linha que começa em ou antes do deslocamento. */
+    int esquerda = 0;
+    int direita = ctx->fluxo_tokens->total_linhas - 1;
+    while (esquerda < direita) {
+        int meio = (esquerda + direita + 1) / 2;
+        if (ctx->fluxo_tokens->inicios_linha[meio] <= deslocamento) {
+            esquerda = meio;
         } else {
-            sprintf(erro_msg, "Caractere não reconhecido (ASCII: %d) na linha %d.", c, linha_atual);
+            direita = meio - 1;
+        }
+    }
+    return esquerda + 1;
+}
+
+/* Conta caracteres, não bytes: bytes de continuação UTF-8 (10xxxxxx) não abrem coluna nova. */
+static int contar_caracteres(const unsigned char* inicio, const unsigned char* fim) {
+    int total = 0;
+    for (; inicio < fim; inicio++) {
+        if ((*inicio & 0xC0) != 0x80) total++;
+    }
+    return total;
+}
+
+int coluna_do_deslocamento(ContextoCompilador* ctx, unsigned int deslocamento, int linha) {
+    const unsigned char* dados = (const unsigned char*) ctx->fonte.dados;
+    return 1 + contar_caracteres(dados + ctx->fluxo_tokens->inicios_linha[linha - 1], dados + deslocamento);
+}
+
+void posicao_do_deslocamento(ContextoCompilador* ctx, unsigned int deslocamento, int* linha, int* coluna) {
+    *linha = linha_do_deslocamento(ctx, deslocamento);
+    *coluna = coluna_do_deslocamento(ctx, deslocamento, *linha);
+}
+
+/*
+ * Como coluna_do_deslocamento(), mas parte do último deslocamento convertido
+ * quando ele está na mesma linha e mais perto que o início dela. O parser pede
+ * os tokens em ordem, então cada byte de uma linha longa é contado uma vez, e
+ * não uma vez por token da linha.
+ */
+static int coluna_pelo_cursor(ContextoCompilador* ctx, unsigned int deslocamento, int linha) {
+    FluxoTokens* fluxo = ctx->fluxo_tokens;
+    const unsigned char* dados = (const unsigned char*) ctx->fonte.dados;
+    unsigned int inicio_linha = fluxo->inicios_linha[linha - 1];
+    unsigned int cursor = fluxo->cursor_deslocamento;
+    int coluna;
+
+    if (cursor >= inicio_linha && (linha == fluxo->total_linhas || cursor < fluxo->inicios_linha[linha])) {
+        unsigned int distancia = cursor > deslocamento ? cursor - deslocamento : deslocamento - cursor;
+        if (distancia < deslocamento - inicio_linha) {
+            coluna = cursor <= deslocamento
+                   ? fluxo->cursor_coluna + contar_caracteres(dados + cursor, dados + deslocamento)
+                   : fluxo->cursor_coluna - contar_caracteres(dados + deslocamento, dados + cursor);
+            fluxo->cursor_deslocamento = deslocamento;
+            fluxo->cursor_coluna = coluna;
+            return coluna;
+        }
+    }
+
+    coluna = 1 + contar_caracteres(dados + inicio_linha, dados + deslocamento);
+    fluxo->cursor_deslocamento = deslocamento;
+    fluxo->cursor_coluna = coluna;
+    return coluna;
+}
+
+Token token_na_posicao(ContextoCompilador* ctx, int indice) {
+    TipoToken tipo = (TipoToken) ctx->fluxo_tokens->tipos[indice];
+    unsigned int inicio = ctx->fluxo_tokens->inicios[indice];
+    int linha = linha_do_deslocamento(ctx, inicio);
+    int coluna = coluna_pelo_cursor(ctx, inicio, linha);
+
+    if (tipo == TOKEN_ERRO) {
+        return criar_token(tipo, ctx->fluxo_tokens->mensagem_erro, linha, coluna);
+    }
+    if (lexemas_fixos[tipo] != NULL) {
+        return criar_token(tipo, lexemas_fixos[tipo], linha, coluna);
+    }
+    /* Nomes e literais usam a cópia canônica da tabela de nomes, estável até o fim da compilação. */
+    Token token = criar_token_nome(ctx, tipo, ctx->fonte.dados + inicio, ctx->fluxo_tokens->tamanhos[indice], linha, coluna);
+    if (tipo != TOKEN_ID_VARIAVEL && tipo != TOKEN_ID_FUNCAO) {
+        token.id_nome = -1;
+    }
+    return token;
+}
+
+/* --- ANÁLISE LÉXICA EM BLOCOS --- */
+
+/*
+ * Nenhum token atravessa uma quebra de linha (literais de texto são recusados
+ * ao encontrá-la), então um arquivo grande pode ser dividido em blocos que
+ * começam em inícios de linha e varridos em paralelo. Cada bloco é varrido
+ * duas vezes: a primeira passada só conta os tokens, o que dá a cada bloco sua
+ * faixa exata no fluxo; a segunda grava os tokens direto nessa faixa. O fluxo
+ * ocupa assim um único bloco do tamanho exato, sem cópia ao juntar os blocos,
+ * e as linhas continuam corretas porque os tokens guardam deslocamentos
+ * absolutos no código-fonte.
+ */
+
+#define TAMANHO_BLOCO_LEXICO (1024 * 1024)
+#define MAXIMO_BLOCOS_LEXICO 64
+/*
+ * Em um só núcleo a varredura em blocos é mais lenta (0,047 s contra 0,036 s
+ * em 27 MB); o ganho com vários núcleos ainda não foi medido, e este limiar
+ * deve ser revisto quando for.
+ */
+#define MINIMO_BYTES_LEXICO_EM_BLOCOS (2 * TAMANHO_BLOCO_LEXICO)
+
+typedef struct {
+    ContextoCompilador* ctx;
+    size_t inicio;   /* Primeiro byte do bloco, sempre um início de linha. */
+    size_t fim;      /* Fim exclusivo: início da linha seguinte ao bloco ou fim do arquivo. */
+    int total;       /* Tokens do bloco, contados na primeira passada. */
+    int primeiro;    /* Posição do primeiro token do bloco no fluxo. */
+    int com_erro;    /* O último token contado é um token de erro. */
+    char mensagem_erro[TAMANHO_MENSAGEM_ERRO_LEXICO];
+} BlocoLexico;
+
+/* Fonte restrita ao bloco: para o analisador, o fim do bloco é o fim de arquivo. */
+static FonteBuffer fonte_do_bloco(const BlocoLexico* bloco) {
+    FonteBuffer fonte = bloco->ctx->fonte;
+    fonte.posicao = bloco->inicio;
+    fonte.tamanho = bloco->fim;
+    return fonte;
+}
+
+static void contar_tokens_bloco(void* argumento) {
+    BlocoLexico* bloco = (BlocoLexico*) argumento;
+    FonteBuffer fonte = fonte_do_bloco(bloco);
+    /* Só o último bloco termina no fim de arquivo verdadeiro e guarda o token EOF. */
+    int ultimo = bloco->fim == bloco->ctx->fonte.tamanho;
+    TokenBruto token;
+    for (;;) {
+        token = varrer_token(bloco->ctx, &fonte, bloco->mensagem_erro);
+        if (token.tipo == TOKEN_FIM_DE_ARQUIVO) {
+            bloco->total += ultimo;
+            break;
+        }
+        bloco->total++;
+        if (token.tipo == TOKEN_ERRO) {
+            bloco->com_erro = 1;
+            break;
+        }
+    }
+}
+
+static void gravar_tokens_bloco(void* argumento) {
+    BlocoLexico* bloco = (BlocoLexico*) argumento;
+    FluxoTokens* fluxo = bloco->ctx->fluxo_tokens;
+    FonteBuffer fonte = fonte_do_bloco(bloco);
+    char mensagem_descartada[TAMANHO_MENSAGEM_ERRO_LEXICO];
+    for (int i = bloco->primeiro; i < bloco->primeiro + bloco->total; i++) {
+        TokenBruto token = varrer_token(bloco->ctx, &fonte, mensagem_descartada);
+        fluxo->tipos[i] = (unsigned char) token.tipo;
+        fluxo->inicios[i] = token.inicio;
+        fluxo->tamanhos[i] = (unsigned short) token.tamanho;
+    }
+}
+
+static int gerar_tokens_em_blocos(ContextoCompilador* ctx) {
+    FonteBuffer* fonte = &ctx->fonte;
+    int total_blocos = (int) (fonte->tamanho / TAMANHO_BLOCO_LEXICO);
+    if (total_blocos > MAXIMO_BLOCOS_LEXICO) total_blocos = MAXIMO_BLOCOS_LEXICO;
+    BlocoLexico* blocos = (BlocoLexico*) alocar_na_regiao(ctx, REGIAO_LEXICO, sizeof(BlocoLexico) * total_blocos);
+
+    /* Cada fronteira avança até o início da próxima linha; blocos que ficariam vazios são descartados. */
+    int usados = 0;
+    size_t inicio = 0;
+    for (int i = 1; i <= total_blocos && inicio < fonte->tamanho; i++) {
+        size_t alvo = i < total_blocos ? fonte->tamanho / total_blocos * i : fonte->tamanho;
+        if (alvo < inicio) continue; /* Uma linha maior que um bloco já levou a fronteira além do alvo. */
+        const char* quebra = alvo < fonte->tamanho ? (const char*) memchr(fonte->dados + alvo, '\n', fonte->tamanho - alvo) : NULL;
+        size_t fim = quebra != NULL ? (size_t) (quebra - fonte->dados) + 1 : fonte->tamanho;
+        memset(&blocos[usados], 0, sizeof(BlocoLexico));
+        blocos[usados].ctx = ctx;
+        blocos[usados].inicio = inicio;
+        blocos[usados].fim = fim;
+        usados++;
+        inicio = fim;
+    }
+
+    GrupoTarefas grupo;
+    inicializar_grupo_tarefas(&grupo);
+    for (int i = 0; i < usados; i++) {
+        submeter_tarefa(ctx->escalonador, &grupo, contar_tokens_bloco, &blocos[i]);
+    }
+    aguardar_grupo_tarefas(ctx->escalonador, &grupo);
+
+    /* Como na varredura sequencial, o fluxo termina no primeiro token de erro: blocos seguintes são descartados. */
+    int total = 0;
+    int erro = -1;
+    for (int i = 0; i < usados && erro < 0; i++) {
+        blocos[i].primeiro = total;
+        total += blocos[i].total;
+        if (blocos[i].com_erro) erro = i;
+    }
+    if (erro >= 0) usados = erro + 1;
+
+    reservar_vetores_tokens(ctx, total);
+    ctx->fluxo_tokens->total = total;
+    for (int i = 0; i < usados; i++) {
+        submeter_tarefa(ctx->escalonador, &grupo, gravar_tokens_bloco, &blocos[i]);
+    }
+    aguardar_grupo_tarefas(ctx->escalonador, &grupo);
+
+    if (erro >= 0) {
+        ctx->fluxo_tokens->mensagem_erro = copiar_texto_na_regiao(ctx, REGIAO_LEXICO, blocos[erro].mensagem_erro, strlen(blocos[erro].mensagem_erro));
+        return 0;
+    }
+    return 1;
+}
+
+int gerar_tokens(ContextoCompilador* ctx) {
+    ctx->fluxo_tokens = (FluxoTokens*) alocar_na_regiao(ctx, REGIAO_LEXICO, sizeof(FluxoTokens));
+    /* Tudo zerado antes de alocar: destruir_fluxo_tokens() funciona mesmo se a memória acabar aqui. */
+    memset(ctx->fluxo_tokens, 0, sizeof(FluxoTokens));
+
+    /* Arquivos grandes são varridos em blocos paralelos quando há um escalonador. */
+    if (ctx->escalonador != NULL && ctx->fonte.tamanho >= MINIMO_BYTES_LEXICO_EM_BLOCOS) {
+        indexar_linhas(ctx);
+        return gerar_tokens_em_blocos(ctx);
+    }
+
+    /* Dimensiona pelo tamanho do arquivo para que a maioria das fontes não precise crescer. */
+    reservar_vetores_tokens(ctx, (int)(ctx->fonte.tamanho / BYTES_FONTE_POR_TOKEN) + CAPACIDADE_INICIAL_TOKENS);
+    indexar_linhas(ctx);
+
+    TokenBruto token;
+    do {
+        token = obter_proximo_token(ctx);
+        adicionar_token(ctx, token);
+        if (token.tipo == TOKEN_ERRO) {
+            ctx->fluxo_tokens->mensagem_erro = copiar_texto_na_regiao(ctx, REGIAO_LEXICO, ctx->mensagem_erro_lexico, strlen(ctx->mensagem_erro_lexico));
+            return 0;
         }
-        return criar_token(TOKEN_ERRO, erro_msg, linha_atual);
+    } while (token.tipo != TOKEN_FIM_DE_ARQUIVO);
+
+    return 1;
+}
+
+void destruir_fluxo_tokens(ContextoCompilador* ctx) {
+    if (ctx->fluxo_tokens) {
+        /* Os três vetores paralelos começam em inicios (um único bloco). */
+        liberar_memoria(ctx, ctx->fluxo_tokens->inicios, BYTES_POR_TOKEN * ctx->fluxo_tokens->capacidade, CATEGORIA_TOKENS);
+        liberar_memoria(ctx, ctx->fluxo_tokens->inicios_linha, sizeof(unsigned int) * ctx->fluxo_tokens->capacidade_linhas, CATEGORIA_TOKENS);
+        /* A estrutura e a mensagem de erro pertencem à região léxica. */
+        liberar_regiao(ctx, REGIAO_LEXICO);
+        ctx->fluxo_tokens = NULL;
+    }
+}
+
+/* --- CONTEXTO DE COMPILAÇÃO --- */
+
+void inicializar_contexto(ContextoCompilador* ctx) {
+    memset(ctx, 0, sizeof(ContextoCompilador));
+    ctx->saida = stdout;
+    ctx->erros = stderr;
+
+    ctx->memoria.limite = MEMORIA_MAXIMA_KB * 1024;
+    ctx->memoria.percentual_alerta = PERCENTUAL_ALERTA_MEMORIA;
+    for (int i = 0; i < TOTAL_REGIOES; i++) {
+        arena_inicializar(ctx, &ctx->memoria.regioes[i], formato_regioes[i].tamanho_bloco, formato_regioes[i].categoria);
     }
 
-    return criar_token(TOKEN_FIM_DE_ARQUIVO, "EOF", linha_atual);
-}
\ No newline at end of file
+    ctx->varredura = selecionar_kernels_varredura(ctx);
+}
+
+void destruir_contexto(ContextoCompilador* ctx) {
+    destruir_fluxo_tokens(ctx);
+    fechar_fonte(ctx);
+
+    if (ctx->tabela_simbolos) {
+        destruir_tabela_simbolos(ctx);
+    }
+
+    if (ctx->pilha_balanceamento) {
+        destruir_pilha_balanceamento(ctx);
+    }
+
+    if (ctx->arvore) {
+        destruir_arvore_sintatica(ctx);
+    }
+
+    /* Limpa recursos semânticos */
+    destruir_analisador_semantico(ctx);
+    destruir_tabela_nomes(ctx);
+}
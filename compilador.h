@@ -7,33 +7,346 @@
 #define COMPILADOR_H
 
 #include <stdio.h>
+#include <setjmp.h>
+
+/**
+ * @struct ContextoCompilador
+ * @brief Todo o estado de uma compilação (definido ao final deste arquivo).
+ *
+ * As funções das fases recebem o contexto como primeiro parâmetro, de modo que
+ * vários contextos podem compilar arquivos distintos no mesmo processo, cada
+ * um em sua própria thread.
+ */
+typedef struct ContextoCompilador ContextoCompilador;
 
 /* --- CONTROLE DE MEMORIA --- */
 
+/**
+ * @enum CategoriaMemoria
+ * @brief Estrutura responsável por uma alocação, usada pelo perfil de alocações.
+ */
+typedef enum {
+    CATEGORIA_TOKENS,    /* Fluxo de tokens e índice de linhas. */
+    CATEGORIA_NOMES,     /* Tabela de nomes e cópias canônicas. */
+    CATEGORIA_SIMBOLOS,  /* Tabela de símbolos. */
+    CATEGORIA_FUNCOES,   /* Registro de funções do analisador semântico. */
+    CATEGORIA_PILHA,     /* Pilha de balanceamento. */
+    CATEGORIA_ARVORE,    /* Árvore sintática. */
+    TOTAL_CATEGORIAS
+} CategoriaMemoria;
+
+/**
+ * @brief Define o orçamento de memória do contexto.
+ *
+ * Valores não positivos são lidos das variáveis de ambiente
+ * COMPILADOR_MEMORIA_KB e COMPILADOR_ALERTA_MEMORIA; na ausência delas valem
+ * MEMORIA_MAXIMA_KB e 90%.
+ * @param ctx O contexto da compilação.
+ * @param limite_kb Limite rígido, em KB: nenhuma alocação pode ultrapassá-lo.
+ * @param percentual_alerta Limite brando, em porcentagem do rígido, a partir do qual é emitido um alerta.
+ */
+void configurar_orcamento_memoria(ContextoCompilador* ctx, long limite_kb, int percentual_alerta);
+
 /**
  * @brief Aloca uma quantidade de memória de forma segura.
  *
  * Esta função verifica se a alocação de memória não ultrapassará o limite
- * definido e interrompe o programa se não houver memória suficiente.
+ * definido no contexto; se não houver memória suficiente, desvia para
+ * ctx->memoria.recuperacao ou interrompe o programa.
+ * @param ctx O contexto cujo orçamento é consumido.
  * @param tamanho A quantidade de bytes a ser alocada.
+ * @param categoria Estrutura responsável, contabilizada no perfil de alocações.
  * @return Um ponteiro para a memória alocada.
  */
-void* alocar_memoria(size_t tamanho);
+void* alocar_memoria(ContextoCompilador* ctx, size_t tamanho, CategoriaMemoria categoria);
 
 /**
  * @brief Libera a memória previamente alocada.
  *
+ * @param ctx O contexto em que a memória foi alocada.
  * @param ptr O ponteiro para a memória a ser liberada.
  * @param tamanho A quantidade de bytes que foi alocada para o ponteiro.
+ * @param categoria A mesma categoria informada na alocação.
+ */
+void liberar_memoria(ContextoCompilador* ctx, void* ptr, size_t tamanho, CategoriaMemoria categoria);
+
+/**
+ * @brief Ativa o perfil de alocações do contexto se a variável de ambiente
+ * COMPILADOR_PERFIL_MEMORIA estiver definida com valor diferente de "0".
+ *
+ * Desativado, o perfil custa um único teste por alocação.
+ * @param ctx O contexto da compilação.
+ */
+void configurar_perfil_memoria(ContextoCompilador* ctx);
+
+/**
+ * @brief Exibe um relatório final sobre o uso de memória do contexto.
+ *
+ * Mostra a memória total, o pico de uso, a memória restante e a ocupação
+ * máxima de cada pool de objetos. Com o perfil ativo, inclui contagens,
+ * bytes, pico e histograma de tamanhos por categoria.
+ * @param ctx O contexto da compilação.
+ */
+void exibir_status_memoria(ContextoCompilador* ctx);
+
+/**
+ * @struct BlocoArena
+ * @brief Bloco contíguo de memória de uma arena; os blocos formam uma lista.
+ */
+typedef struct BlocoArena {
+    struct BlocoArena* anterior;
+    size_t tamanho;  /* Bytes disponíveis em dados. */
+    size_t usado;    /* Bytes já entregues. */
+    char dados[];
+} BlocoArena;
+
+/**
+ * @struct Arena
+ * @brief Alocador por incremento de ponteiro (bump allocator).
+ *
+ * Os blocos são obtidos com alocar_memoria() no contexto da arena, portanto
+ * entram na contabilidade e no orçamento daquela compilação. Objetos individuais não são liberados: a
+ * arena inteira é descartada de uma vez com arena_liberar().
+ */
+typedef struct {
+    ContextoCompilador* contexto;  /* Contexto em cujo orçamento os blocos são contabilizados. */
+    BlocoArena* atual;
+    size_t tamanho_bloco;
+    CategoriaMemoria categoria;  /* Categoria dos blocos no perfil de alocações. */
+} Arena;
+
+/**
+ * @brief Prepara uma arena vazia.
+ * @param ctx O contexto dono da arena.
+ * @param arena A arena a ser inicializada.
+ * @param tamanho_bloco Tamanho padrão, em bytes, de cada bloco reservado.
+ * @param categoria Categoria em que os blocos são contabilizados.
+ */
+void arena_inicializar(ContextoCompilador* ctx, Arena* arena, size_t tamanho_bloco, CategoriaMemoria categoria);
+
+/**
+ * @brief Reserva memória alinhada dentro da arena.
+ * @param arena A arena de origem.
+ * @param tamanho A quantidade de bytes desejada.
+ * @return Ponteiro válido até arena_liberar().
+ */
+void* arena_alocar(Arena* arena, size_t tamanho);
+
+/**
+ * @brief Copia um trecho de texto para a arena, acrescentando o terminador nulo.
+ * @param arena A arena de destino.
+ * @param texto Início do texto (não precisa ser terminado em '\0').
+ * @param tamanho Quantidade de caracteres a copiar.
+ * @return A cópia terminada em '\0'.
+ */
+char* arena_copiar_texto(Arena* arena, const char* texto, size_t tamanho);
+
+/**
+ * @brief Libera todos os blocos da arena em uma única operação.
+ * @param arena A arena a ser liberada.
+ */
+void arena_liberar(Arena* arena);
+
+/**
+ * @enum RegiaoMemoria
+ * @brief Regiões de memória com tempo de vida explícito, uma por fase.
+ *
+ * Cada região é uma arena: os objetos de uma fase são reservados nela e
+ * descartados juntos por liberar_regiao() quando a fase termina, sem percorrer
+ * listas nem informar o tamanho de cada objeto.
+ */
+typedef enum {
+    REGIAO_COMPILACAO,  /* Toda a compilação: cópias canônicas da tabela de nomes. */
+    REGIAO_LEXICO,      /* Fluxo de tokens e mensagem de erro léxico. */
+    REGIAO_SINTATICO,   /* Tabela de símbolos. */
+    REGIAO_SEMANTICO,   /* Registro de funções declaradas e chamadas. */
+    REGIAO_ARVORE,      /* Árvore sintática. */
+    TOTAL_REGIOES
+} RegiaoMemoria;
+
+/**
+ * @brief Reserva memória alinhada em uma região do contexto.
+ * @param ctx O contexto dono da região.
+ * @param regiao A região de origem.
+ * @param tamanho A quantidade de bytes desejada.
+ * @return Ponteiro válido até liberar_regiao(regiao).
+ */
+void* alocar_na_regiao(ContextoCompilador* ctx, RegiaoMemoria regiao, size_t tamanho);
+
+/**
+ * @brief Copia um trecho de texto para uma região, acrescentando o terminador nulo.
+ * @param ctx O contexto dono da região.
+ * @param regiao A região de destino.
+ * @param texto Início do texto (não precisa ser terminado em '\0').
+ * @param tamanho Quantidade de caracteres a copiar.
+ * @return A cópia terminada em '\0'.
+ */
+char* copiar_texto_na_regiao(ContextoCompilador* ctx, RegiaoMemoria regiao, const char* texto, size_t tamanho);
+
+/**
+ * @brief Descarta de uma vez tudo o que foi reservado na região.
+ * @param ctx O contexto dono da região.
+ * @param regiao A região cuja fase terminou.
+ */
+void liberar_regiao(ContextoCompilador* ctx, RegiaoMemoria regiao);
+
+/**
+ * @struct ObjetoLivre
+ * @brief Elo da lista de objetos livres de um pool, gravado no próprio objeto.
+ */
+typedef struct ObjetoLivre {
+    struct ObjetoLivre* proximo;
+} ObjetoLivre;
+
+/**
+ * @struct PoolObjetos
+ * @brief Pool de objetos de tamanho fixo reservados em slabs contíguos.
+ *
+ * Cada slab é reservado na região do pool e encadeado na lista de livres, de
+ * modo que alocar é retirar o primeiro elemento da lista. Objetos do mesmo
+ * tipo ficam lado a lado na memória. Não há devolução avulsa: as entradas
+ * vivem até o fim da fase, e os slabs saem junto com a região;
+ * pool_reiniciar() apenas esquece a lista de livres.
+ */
+typedef struct {
+    ContextoCompilador* contexto;
+    const char* nome;        /* Nome exibido no relatório de memória. */
+    size_t tamanho_objeto;   /* Arredondado para o alinhamento da arena. */
+    int objetos_por_slab;
+    RegiaoMemoria regiao;    /* Região de onde vêm os slabs. */
+    ObjetoLivre* livres;
+    int em_uso;
+    int reservados;          /* Objetos em slabs já reservados. */
+    int pico_em_uso;
+    int pico_reservados;
+} PoolObjetos;
+
+/**
+ * @brief Prepara um pool vazio e o registra para o relatório de memória do contexto.
+ * @param ctx O contexto dono do pool.
+ * @param pool O pool a ser inicializado.
+ * @param nome Nome exibido no relatório.
+ * @param tamanho_objeto Tamanho de cada objeto, em bytes.
+ * @param objetos_por_slab Quantos objetos cada slab comporta.
+ * @param regiao Região cujo tempo de vida o pool acompanha.
+ */
+void pool_inicializar(ContextoCompilador* ctx, PoolObjetos* pool, const char* nome, size_t tamanho_objeto,
+                      int objetos_por_slab, RegiaoMemoria regiao);
+
+/**
+ * @brief Retira um objeto da lista de livres, reservando um novo slab se ela estiver vazia.
+ * @param pool O pool de origem.
+ * @return Ponteiro para o objeto (conteúdo indefinido).
+ */
+void* pool_alocar(PoolObjetos* pool);
+
+/**
+ * @brief Esquece slabs e objetos livres; chamada quando a região do pool é liberada.
+ *
+ * Os picos de ocupação são preservados para o relatório de memória.
+ * @param pool O pool a ser reiniciado.
+ */
+void pool_reiniciar(PoolObjetos* pool);
+
+/* Faixas do histograma: até 16, 64, 256, 1K, 4K, 16K, 64K bytes e acima disso. */
+#define TOTAL_FAIXAS_HISTOGRAMA 8
+
+/**
+ * @struct PerfilCategoria
+ * @brief Contagens do perfil de alocações para uma categoria.
+ */
+typedef struct {
+    long alocacoes;
+    long liberacoes;
+    long bytes_totais;   /* Soma de todos os bytes já alocados. */
+    long bytes_atuais;
+    long bytes_pico;
+    long histograma[TOTAL_FAIXAS_HISTOGRAMA];
+} PerfilCategoria;
+
+#define MAX_POOLS 8
+
+/**
+ * @struct ControleMemoria
+ * @brief Orçamento, contabilidade, regiões e pools de um contexto.
+ */
+typedef struct {
+    long limite;                /* Limite rígido, em bytes. */
+    int percentual_alerta;      /* Limite brando, em % do rígido. */
+    long alocada_atual;
+    long pico_utilizada;
+    int alerta_emitido;
+    /* Se não for NULL, alocar_memoria() emite o diagnóstico e desvia para cá com
+     * longjmp, abandonando a compilação em andamento; se for NULL, o processo é
+     * encerrado. */
+    jmp_buf* recuperacao;
+    int perfil_ativo;
+    PerfilCategoria perfil[TOTAL_CATEGORIAS];
+    Arena regioes[TOTAL_REGIOES];
+    PoolObjetos* pools[MAX_POOLS];  /* Pools conhecidos pelo relatório de memória. */
+    int total_pools;
+} ControleMemoria;
+
+/* --- TABELA DE NOMES --- */
+
+/**
+ * @struct EntradaNome
+ * @brief Cópia canônica de um nome internado.
  */
-void liberar_memoria(void* ptr, size_t tamanho);
+typedef struct {
+    const char* texto;
+    size_t tamanho;
+    unsigned int hash;
+} EntradaNome;
 
 /**
- * @brief Exibe um relatório final sobre o uso de memória do programa.
+ * @struct TabelaNomes
+ * @brief Internador de nomes de variáveis e funções.
  *
- * Mostra a memória total, o pico de uso e a memória restante.
+ * Cada nome distinto recebe um id inteiro pequeno e estável e uma única cópia
+ * canônica, de modo que comparar dois nomes equivale a comparar seus ids. Os
+ * ids são localizados por uma tabela hash de endereçamento aberto.
+ */
+typedef struct {
+    EntradaNome* nomes;  /* Indexado pelo id. */
+    int total;
+    int capacidade_nomes;
+    int* slots;          /* Tabela hash: id + 1, ou 0 para slot vazio. */
+    int capacidade_slots; /* Sempre potência de 2. */
+} TabelaNomes;
+
+/**
+ * @brief Inicializa a tabela de nomes.
+ */
+void inicializar_tabela_nomes(ContextoCompilador* ctx);
+
+/**
+ * @brief Obtém o id de um nome, internando-o se ainda não existir.
+ * @param texto Início do nome (não precisa ser terminado em '\0').
+ * @param tamanho Quantidade de caracteres do nome.
+ * @return O id do nome.
+ */
+int internar_nome(ContextoCompilador* ctx, const char* texto, size_t tamanho);
+
+/**
+ * @brief Procura um nome sem internar.
+ * @param texto Início do nome.
+ * @param tamanho Quantidade de caracteres do nome.
+ * @return O id do nome ou -1 se ele nunca foi internado.
  */
-void exibir_status_memoria();
+int buscar_id_nome(ContextoCompilador* ctx, const char* texto, size_t tamanho);
+
+/**
+ * @brief Retorna a cópia canônica de um nome internado.
+ * @param id O id do nome.
+ * @return O nome terminado em '\0'.
+ */
+const char* nome_por_id(ContextoCompilador* ctx, int id);
+
+/**
+ * @brief Libera a tabela de nomes e todas as cópias canônicas.
+ */
+void destruir_tabela_nomes(ContextoCompilador* ctx);
 
 /* --- ANALISADOR LEXICO --- */
 
@@ -57,18 +370,60 @@ typedef enum {
 
 /**
  * @struct Token
- * @brief Estrutura que representa um token individual.
+ * @brief Visão de um token individual, montada a partir do fluxo de tokens.
  *
- * Contém o tipo do token, seu valor textual (lexema) e a linha onde foi encontrado.
+ * Contém o tipo do token, seu valor textual (lexema) e a linha e coluna onde foi encontrado.
  */
 typedef struct {
     TipoToken tipo;
-    char* lexema;
+    const char* lexema;
     int linha;
+    int coluna;   /* Coluna (a partir de 1, em caracteres) do início do lexema. */
+    int id_nome;  /* Id na tabela de nomes (ID_VARIAVEL/ID_FUNCAO); -1 nos demais tokens. */
 } Token;
 
-extern FILE* arquivo_fonte; /* Ponteiro para o arquivo de código-fonte sendo analisado. */
-extern int linha_atual;     /* Contador da linha atual no arquivo-fonte. */
+#define TAMANHO_JANELA_TOKENS 4  /* Potência de 2: o lugar no anel é posição & (tamanho - 1). */
+
+/**
+ * @struct JanelaTokens
+ * @brief Anel com os próximos tokens do parser já montados (ver espiar_token()).
+ *
+ * Cada token é montado uma única vez, quando é espiado ou consumido, e o anel
+ * cobre as posições de posicao_token até fim - 1.
+ */
+typedef struct {
+    Token itens[TAMANHO_JANELA_TOKENS];
+    int fim;  /* Posição em fluxo_tokens seguinte ao último token montado. */
+} JanelaTokens;
+
+/**
+ * @struct FonteBuffer
+ * @brief Código-fonte mantido inteiramente em memória contígua.
+ *
+ * O arquivo é mapeado em memória (ou lido em uma única chamada) e o analisador
+ * léxico percorre os bytes por índice, sem E/S por caractere.
+ */
+typedef struct {
+    const char* dados;  /* Conteúdo do arquivo (não terminado em '\0'). */
+    size_t tamanho;     /* Quantidade de bytes em dados. */
+    size_t posicao;     /* Índice do próximo caractere a ser lido. */
+    int mapeado;        /* 1 se dados veio de mmap, 0 se foi lido para um buffer. */
+} FonteBuffer;
+
+/**
+ * @brief Carrega o arquivo-fonte inteiro em memória.
+ *
+ * Em sistemas POSIX o arquivo é mapeado com mmap; nos demais é lido com uma
+ * única chamada a fread.
+ * @param caminho Caminho do arquivo a ser analisado.
+ * @return 1 se carregado com sucesso, 0 se erro (errno preservado).
+ */
+int abrir_fonte(ContextoCompilador* ctx, const char* caminho);
+
+/**
+ * @brief Libera o buffer do código-fonte carregado por abrir_fonte().
+ */
+void fechar_fonte(ContextoCompilador* ctx);
 
 /**
  * @brief Converte um TipoToken para sua representação em string.
@@ -80,27 +435,129 @@ extern int linha_atual;     /* Contador da linha atual no arquivo-fonte. */
 const char* tipo_token_para_str(TipoToken tipo);
 
 /**
- * @brief Converte um TipoToken para sua representação em string.
+ * @brief Cria um token cujo lexema já tem duração garantida.
  *
- * Útil para exibir o tipo de token de forma legível.
- * @param tipo O tipo de token a ser convertido.
- * @return Uma string representando o tipo de token.
+ * O lexema não é copiado: deve ser uma constante (operadores, palavras
+ * reservadas) ou uma cópia canônica da tabela de nomes.
+ * @param tipo O tipo do token.
+ * @param lexema O texto do token.
+ * @param linha A linha onde o token foi encontrado.
+ * @param coluna A coluna onde o token começa.
+ * @return O token criado.
  */
-Token criar_token(TipoToken tipo, char* lexema, int linha);
+Token criar_token(TipoToken tipo, const char* lexema, int linha, int coluna);
 
 /**
- * @brief Libera a memória alocada para um token.
- * @param token O token a ser destruído.
+ * @brief Cria um token usando a cópia canônica do lexema na tabela de nomes.
+ * @param tipo O tipo do token (nomes e literais).
+ * @param texto Início do lexema no buffer do código-fonte.
+ * @param tamanho Quantidade de caracteres do nome.
+ * @param linha A linha onde o token foi encontrado.
+ * @param coluna A coluna onde o token começa.
+ * @return O token criado, com id_nome preenchido.
  */
-void destruir_token(Token token);
+Token criar_token_nome(ContextoCompilador* ctx, TipoToken tipo, const char* texto, size_t tamanho, int linha, int coluna);
 
 /**
- * @brief Lê o arquivo-fonte e retorna o próximo token encontrado.
+ * @struct TokenBruto
+ * @brief Resultado do analisador léxico: o tipo e a fatia do código-fonte.
  *
- * É o coração do analisador léxico.
+ * Para literais de texto a fatia cobre apenas o conteúdo entre as aspas.
+ */
+typedef struct {
+    TipoToken tipo;
+    unsigned int inicio;   /* Deslocamento do lexema no buffer do código-fonte. */
+    unsigned int tamanho;  /* Quantidade de bytes do lexema. */
+} TokenBruto;
+
+/**
+ * @brief Lê o buffer do código-fonte e retorna o próximo token encontrado.
+ *
+ * É o coração do analisador léxico. Nenhum lexema é copiado: o token
+ * referencia o trecho correspondente do buffer.
  * @return O próximo token do arquivo.
  */
-Token obter_proximo_token();
+TokenBruto obter_proximo_token(ContextoCompilador* ctx);
+
+/**
+ * @struct FluxoTokens
+ * @brief Sequência compacta de tokens produzida por uma única passagem do analisador léxico.
+ *
+ * É preenchida uma vez e compartilhada pela listagem léxica, pelo analisador
+ * sintático e pelas verificações semânticas, de modo que o código-fonte seja
+ * varrido apenas uma vez. Os tokens ficam em vetores paralelos (estrutura de
+ * vetores) reservados em um único bloco que começa em inicios: 7 bytes por
+ * token, sem cópia do lexema. A linha de cada token é obtida a partir da
+ * tabela de inícios de linha.
+ */
+typedef struct {
+    unsigned char* tipos;        /* TipoToken de cada token. */
+    unsigned int* inicios;       /* Deslocamento do lexema no código-fonte. */
+    unsigned short* tamanhos;    /* Tamanho do lexema. */
+    int total;
+    int capacidade;
+    unsigned int* inicios_linha; /* Deslocamento do primeiro byte de cada linha. */
+    int total_linhas;
+    int capacidade_linhas;
+    unsigned int cursor_deslocamento; /* Último deslocamento convertido por token_na_posicao()... */
+    int cursor_coluna;                /* ...e sua coluna: a contagem segue daí, não do início da linha. */
+    char* mensagem_erro;         /* Mensagem do token de erro final, se houver. */
+} FluxoTokens;
+
+/**
+ * @brief Percorre todo o código-fonte e armazena os tokens em ctx->fluxo_tokens.
+ *
+ * A varredura termina no fim de arquivo ou no primeiro token de erro, que
+ * também é armazenado como último elemento.
+ *
+ * Com ctx->escalonador definido (só com --threads explícito), arquivos
+ * grandes são divididos em blocos de linhas inteiras varridos em paralelo; o fluxo resultante é idêntico ao da
+ * varredura sequencial.
+ * @return 1 se nenhum erro léxico foi encontrado, 0 caso contrário.
+ */
+int gerar_tokens(ContextoCompilador* ctx);
+
+/**
+ * @brief Calcula a linha (a partir de 1) de um deslocamento do código-fonte.
+ * @param deslocamento Posição do byte no buffer do código-fonte.
+ * @return O número da linha.
+ */
+int linha_do_deslocamento(ContextoCompilador* ctx, unsigned int deslocamento);
+
+/**
+ * @brief Calcula a coluna (a partir de 1) de um deslocamento dentro da sua linha.
+ *
+ * A coluna é contada em caracteres UTF-8, não em bytes.
+ * @param deslocamento Posição do byte no buffer do código-fonte.
+ * @param linha A linha do deslocamento, obtida com linha_do_deslocamento().
+ * @return O número da coluna.
+ */
+int coluna_do_deslocamento(ContextoCompilador* ctx, unsigned int deslocamento, int linha);
+
+/**
+ * @brief Converte um deslocamento do código-fonte em linha e coluna.
+ *
+ * Usada pelos diagnósticos: nenhuma fase precisa contar linhas enquanto lê.
+ * @param deslocamento Posição do byte no buffer do código-fonte.
+ * @param linha Recebe o número da linha.
+ * @param coluna Recebe o número da coluna.
+ */
+void posicao_do_deslocamento(ContextoCompilador* ctx, unsigned int deslocamento, int* linha, int* coluna);
+
+/**
+ * @brief Monta a visão Token de um elemento do fluxo.
+ *
+ * O lexema retornado é terminado em '\0' e permanece válido até o fim da
+ * compilação.
+ * @param indice Posição do token em ctx->fluxo_tokens.
+ * @return O token com tipo, lexema, linha e coluna.
+ */
+Token token_na_posicao(ContextoCompilador* ctx, int indice);
+
+/**
+ * @brief Libera o fluxo de tokens e a tabela de linhas.
+ */
+void destruir_fluxo_tokens(ContextoCompilador* ctx);
 
 /* --- TABELA DE SÍMBOLOS --- */
 
@@ -128,30 +585,35 @@ typedef struct {
  * @brief Entrada individual na tabela de símbolos.
  */
 typedef struct EntradaTabela {
-    char* nome;
+    const char* nome;          /* Cópia canônica da tabela de nomes. */
+    int id_nome;
     TipoDado tipo;
     char* valor;
-    char* funcao_escopo;
+    const char* funcao_escopo; /* Cópia canônica da tabela de nomes. */
     LimitadorTamanho limitador;
     int tem_limitador;
+    int ordem;                 /* Posição na ordem de declaração, a partir de 0. */
     struct EntradaTabela* proxima;
 } EntradaTabela;
 
 /**
  * @struct TabelaSimbolos
- * @brief Tabela de símbolos implementada como lista ligada.
+ * @brief Tabela de símbolos: lista ligada (ordem de declaração) com índice hash.
+ *
+ * O índice usa endereçamento aberto com sondagem linear, indexado pelo id do
+ * nome, e dobra de tamanho quando a carga passa de 50%.
  */
 typedef struct {
     EntradaTabela* primeira;
     int total_entradas;
+    EntradaTabela** indice;  /* Slots do índice hash; NULL indica slot vazio. */
+    int capacidade_indice;   /* Sempre potência de 2. */
 } TabelaSimbolos;
 
-extern TabelaSimbolos* tabela_simbolos;
-
 /**
  * @brief Inicializa a tabela de símbolos.
  */
-void inicializar_tabela_simbolos();
+void inicializar_tabela_simbolos(ContextoCompilador* ctx);
 
 /**
  * @brief Adiciona uma variável na tabela de símbolos.
@@ -161,7 +623,7 @@ void inicializar_tabela_simbolos();
  * @param limitador Limitadores de tamanho (se aplicável)
  * @param tem_limitador Se tem limitadores definidos
  */
-void adicionar_variavel(const char* nome, TipoDado tipo, const char* funcao_escopo,
+void adicionar_variavel(ContextoCompilador* ctx, const char* nome, TipoDado tipo, const char* funcao_escopo,
                        LimitadorTamanho limitador, int tem_limitador);
 
 /**
@@ -169,96 +631,205 @@ void adicionar_variavel(const char* nome, TipoDado tipo, const char* funcao_esco
  * @param nome Nome da variável a buscar
  * @return Ponteiro para a entrada ou NULL se não encontrada
  */
-EntradaTabela* buscar_variavel(const char* nome);
+EntradaTabela* buscar_variavel(ContextoCompilador* ctx, const char* nome);
+
+/**
+ * @brief Busca uma variável pelo id do nome na tabela de nomes.
+ * @param id_nome Id retornado por internar_nome()
+ * @return Ponteiro para a entrada ou NULL se não encontrada
+ */
+EntradaTabela* buscar_variavel_id(ContextoCompilador* ctx, int id_nome);
 
 /**
  * @brief Exibe o conteúdo da tabela de símbolos.
  */
-void exibir_tabela_simbolos();
+void exibir_tabela_simbolos(ContextoCompilador* ctx);
 
 /**
  * @brief Libera toda a memória da tabela de símbolos.
  */
-void destruir_tabela_simbolos();
+void destruir_tabela_simbolos(ContextoCompilador* ctx);
 
-/* --- ANALISADOR SINTÁTICO --- */
+/* --- ÁRVORE SINTÁTICA --- */
+
+/**
+ * @enum TipoNo
+ * @brief Tipos de nó da árvore sintática.
+ *
+ * O token de cada nó é o que o origina; os filhos estão listados em ordem.
+ */
+typedef enum {
+    NO_PROGRAMA,    /* Token: fim de arquivo. Filhos: funções e declarações globais. */
+    NO_FUNCAO,      /* Token: nome da função ou 'principal'. Filhos: parâmetros e bloco. */
+    NO_PARAMETRO,   /* Token: nome do parâmetro; o tipo é o token anterior. */
+    NO_DECLARACAO,  /* Token: tipo. Filhos: uma NO_VARIAVEL por variável declarada. */
+    NO_BLOCO,       /* Token: '{'. Filhos: declarações e comandos. */
+    NO_LEIA,        /* Filhos: variáveis lidas. */
+    NO_ESCREVA,     /* Filhos: argumentos. */
+    NO_SE,          /* Filhos: condição, comando e, se houver, o comando do 'senao'. */
+    NO_PARA,        /* Filhos: inicialização, condição, incremento e corpo. */
+    NO_RETORNO,     /* Filho: valor retornado. */
+    NO_ATRIBUICAO,  /* Token: variável de destino. Filho: valor. */
+    NO_INCREMENTO,  /* Token: '++' ou '--'. Filho: variável. */
+    NO_CHAMADA,     /* Token: nome da função. Filhos: argumentos. */
+    NO_BINARIO,     /* Token: operador aritmético, relacional ou lógico. Filhos: operandos. */
+    NO_VARIAVEL,    /* Token: nome. Em uma declaração, o filho opcional é o valor inicial. */
+    NO_NUMERO,
+    NO_TEXTO,
+    NO_VAZIO        /* Parte omitida do 'para'. */
+} TipoNo;
+
+#define NO_NULO (-1)
 
-extern Token token_atual;
-extern int erro_sintatico_encontrado;
+#define BITS_BLOCO_ARVORE 8
+#define NOS_POR_BLOCO_ARVORE (1 << BITS_BLOCO_ARVORE)
+
+/**
+ * @struct BlocoArvore
+ * @brief NOS_POR_BLOCO_ARVORE nós consecutivos, em vetores paralelos.
+ */
+typedef struct {
+    int tokens[NOS_POR_BLOCO_ARVORE];            /* Índice do token de origem em fluxo_tokens. */
+    int primeiros_filhos[NOS_POR_BLOCO_ARVORE];  /* NO_NULO nas folhas. */
+    int proximos_irmaos[NOS_POR_BLOCO_ARVORE];   /* NO_NULO no último filho. */
+    unsigned char tipos[NOS_POR_BLOCO_ARVORE];   /* TipoNo de cada nó. */
+} BlocoArvore;
+
+/**
+ * @struct ArvoreSintatica
+ * @brief Árvore produzida pelo parser, em blocos de nós indexados pelo número do nó.
+ *
+ * Os nós se ligam por índices (primeiro filho e próximo irmão), não por
+ * ponteiros, e o lexema, a linha e a coluna vêm do token de origem em
+ * ctx->fluxo_tokens. Os blocos são reservados na região da árvore à medida
+ * que o parser cria nós, sem cópia ao crescer, e a árvore inteira é
+ * descartada com uma única liberação. Use CAMPO_NO() para ler um campo.
+ */
+typedef struct {
+    BlocoArvore** blocos;
+    int total_blocos;
+    int capacidade_blocos;
+    int total;
+    int raiz;               /* Nó NO_PROGRAMA, ou NO_NULO antes da análise. */
+} ArvoreSintatica;
+
+/* Campo de um nó: CAMPO_NO(arvore, tipos, no), CAMPO_NO(arvore, primeiros_filhos, no)... */
+#define CAMPO_NO(arvore, campo, no) \
+    ((arvore)->blocos[(no) >> BITS_BLOCO_ARVORE]->campo[(no) & (NOS_POR_BLOCO_ARVORE - 1)])
+
+/**
+ * @brief Reserva a árvore sintática vazia para o fluxo de tokens atual.
+ */
+void inicializar_arvore_sintatica(ContextoCompilador* ctx);
+
+/**
+ * @brief Libera a árvore sintática de uma vez.
+ */
+void destruir_arvore_sintatica(ContextoCompilador* ctx);
+
+/**
+ * @struct PilhaOperacoes
+ * @brief Operadores de uma sequência associativa à direita ('a ^ b ^ c') à espera dos nós.
+ *
+ * O parser lê a sequência em laço, empilhando cada operador com seu operando
+ * esquerdo, e só monta a cadeia de nós ao fim dela: a profundidade da pilha
+ * de chamadas não cresce com o número de operandos.
+ */
+typedef struct {
+    int* itens;      /* Pares (token do operador, nó do operando esquerdo), na região sintática. */
+    int total;       /* Inteiros ocupados: o dobro dos pares. */
+    int capacidade;
+} PilhaOperacoes;
+
+/* --- ANALISADOR SINTÁTICO --- */
 
 /**
  * @brief Inicializa o analisador sintático.
  */
-void inicializar_parser();
+void inicializar_parser(ContextoCompilador* ctx);
 
 /**
  * @brief Consome o token atual e avança para o próximo.
  */
-void consumir_token();
+void consumir_token(ContextoCompilador* ctx);
+
+/**
+ * @brief Consulta um token à frente sem consumi-lo.
+ *
+ * O ponteiro aponta para uma vaga do anel e só vale até a próxima chamada de
+ * espiar_token() ou consumir_token(); para guardar um token por mais tempo,
+ * copie a struct (o lexema é canônico e continua válido).
+ * @param distancia 0 para o token atual, até TAMANHO_JANELA_TOKENS - 1; além do
+ * fim do arquivo, devolve o token de fim de arquivo
+ * @return O token na posição posicao_token + distancia
+ */
+const Token* espiar_token(ContextoCompilador* ctx, int distancia);
 
 /**
  * @brief Verifica se o token atual é do tipo esperado e consome.
  * @param tipo_esperado Tipo de token esperado
  * @return 1 se correto, 0 se erro
  */
-int esperar_token(TipoToken tipo_esperado);
+int esperar_token(ContextoCompilador* ctx, TipoToken tipo_esperado);
 
 /**
- * @brief Inicia a análise sintática do programa.
+ * @brief Inicia a análise sintática do programa e monta ctx->arvore.
  * @return 1 se análise bem-sucedida, 0 se erro
  */
-int analisar_programa();
+int analisar_programa(ContextoCompilador* ctx);
 
 /**
  * @brief Analisa uma declaração de função.
+ * @param no Recebe o nó NO_FUNCAO
  * @return 1 se bem-sucedida, 0 se erro
  */
-int analisar_funcao();
+int analisar_funcao(ContextoCompilador* ctx, int* no);
 
 /**
  * @brief Analisa uma declaração de variável.
  * @param funcao_escopo Nome da função atual
+ * @param no Recebe o nó NO_DECLARACAO
  * @return 1 se bem-sucedida, 0 se erro
  */
-int analisar_declaracao_variavel(const char* funcao_escopo);
+int analisar_declaracao_variavel(ContextoCompilador* ctx, const char* funcao_escopo, int* no);
 
 /**
  * @brief Analisa um comando (leia, escreva, se, para, etc.).
  * @param funcao_escopo Nome da função atual
+ * @param no Recebe o nó do comando
  * @return 1 se bem-sucedida, 0 se erro
  */
-int analisar_comando(const char* funcao_escopo);
+int analisar_comando(ContextoCompilador* ctx, const char* funcao_escopo, int* no);
 
 /**
  * @brief Analisa um bloco de comandos entre chaves.
  * @param funcao_escopo Nome da função atual
+ * @param no Recebe o nó NO_BLOCO
  * @return 1 se bem-sucedida, 0 se erro
  */
-int analisar_bloco(const char* funcao_escopo);
+int analisar_bloco(ContextoCompilador* ctx, const char* funcao_escopo, int* no);
 
 /**
- * @brief Analisa uma expressão matemática completa (precedência baixa: + e -).
+ * @brief Analisa uma expressão matemática (+, -, *, /, ^) por precedência de operadores.
+ * @param no Recebe a raiz da subárvore
  * @return 1 se bem-sucedida, 0 se erro
  */
-int analisar_expressao();
-
-/**
- * @brief Analisa um termo matemático (precedência média: *, /, ^).
- * @return 1 se bem-sucedida, 0 se erro
- */
-int analisar_termo();
+int analisar_expressao(ContextoCompilador* ctx, int* no);
 
 /**
  * @brief Analisa um fator matemático (precedência alta: números, variáveis, parênteses).
+ * @param no Recebe a raiz da subárvore
  * @return 1 se bem-sucedida, 0 se erro
  */
-int analisar_fator();
+int analisar_fator(ContextoCompilador* ctx, int* no);
 
 /**
- * @brief Analisa uma condição (para se, para).
+ * @brief Analisa uma condição (para se, para): comparações ligadas por && e ||,
+ * com && mais forte que ||.
+ * @param no Recebe a raiz da subárvore
  * @return 1 se bem-sucedida, 0 se erro
  */
-int analisar_condicao();
+int analisar_condicao(ContextoCompilador* ctx, int* no);
 
 /**
  * @brief Verifica balanceamento de delimitadores.
@@ -266,42 +837,65 @@ int analisar_condicao();
 typedef struct {
     char delimitador;
     int linha;
+    int coluna;
 } ItemBalanceamento;
 
+/**
+ * @enum ModoBalanceamento
+ * @brief Como o balanceamento de delimitadores é verificado.
+ */
+typedef enum {
+    BALANCEAMENTO_PILHA,   /* O parser empilha e desempilha cada delimitador que aceita. */
+    BALANCEAMENTO_PREVIO   /* Uma varredura dos tipos de token antes do parser; empilhar/desempilhar não fazem nada. */
+} ModoBalanceamento;
+
 typedef struct {
     ItemBalanceamento* itens;
     int topo;
-    int capacidade;
+    int capacidade;        /* Dobra quando enche: não há limite fixo de aninhamento. */
+    ModoBalanceamento modo;
 } PilhaBalanceamento;
 
-extern PilhaBalanceamento* pilha_balanceamento;
-
 /**
  * @brief Inicializa a pilha de balanceamento.
+ *
+ * O modo vem da variável de ambiente COMPILADOR_BALANCEAMENTO ("pilha" ou
+ * "previo"); o padrão é BALANCEAMENTO_PILHA.
+ */
+void inicializar_pilha_balanceamento(ContextoCompilador* ctx);
+
+/**
+ * @brief Verifica o balanceamento de (), {} e [] em uma varredura do fluxo de tokens.
+ *
+ * Usada no modo BALANCEAMENTO_PREVIO, antes da análise sintática. Relata apenas
+ * o primeiro desequilíbrio: depois dele, os pares seguintes não são confiáveis.
+ * @return 1 se balanceado, 0 se erro
  */
-void inicializar_pilha_balanceamento();
+int verificar_balanceamento_previo(ContextoCompilador* ctx);
 
 /**
  * @brief Empilha um delimitador para verificação de balanceamento.
  * @param delimitador Caractere delimitador
  * @param linha Linha onde foi encontrado
+ * @param coluna Coluna onde foi encontrado
  */
-void empilhar_delimitador(char delimitador, int linha);
+void empilhar_delimitador(ContextoCompilador* ctx, char delimitador, int linha, int coluna);
 
 /**
  * @brief Desempilha e verifica balanceamento.
  * @param delimitador_fechamento Delimitador de fechamento
  * @param linha Linha atual
+ * @param coluna Coluna atual
  * @return 1 se balanceado, 0 se erro
  */
-int desempilhar_delimitador(char delimitador_fechamento, int linha);
+int desempilhar_delimitador(ContextoCompilador* ctx, char delimitador_fechamento, int linha, int coluna);
 
 /**
  * @brief Analisa um comando de incremento/decremento (++, --).
  * @param funcao_escopo Nome da função atual
  * @return 1 se bem-sucedida, 0 se erro
  */
-int analisar_incremento_decremento(const char* funcao_escopo);
+int analisar_incremento_decremento(ContextoCompilador* ctx, const char* funcao_escopo);
 
 /**
  * @brief Verifica se um token não deve estar presente (ex: ponto e vírgula após se/para).
@@ -309,65 +903,67 @@ int analisar_incremento_decremento(const char* funcao_escopo);
  * @param contexto Descrição do contexto para mensagem de erro
  * @return 1 se correto (token não presente), 0 se erro
  */
-int verificar_ausencia_token(TipoToken token_nao_esperado, const char* contexto);
+int verificar_ausencia_token(ContextoCompilador* ctx, TipoToken token_nao_esperado, const char* contexto);
 
 /**
  * @brief Libera a pilha de balanceamento.
  */
-void destruir_pilha_balanceamento();
+void destruir_pilha_balanceamento(ContextoCompilador* ctx);
 
 /* --- ANALISADOR SEMÂNTICO --- */
 
-extern int erro_semantico_encontrado;
-extern int alerta_semantico_emitido;
-
 /**
  * @brief Inicializa o analisador semântico.
  */
-void inicializar_analisador_semantico();
+void inicializar_analisador_semantico(ContextoCompilador* ctx);
 
 /**
  * @brief Libera recursos do analisador semântico.
  */
-void destruir_analisador_semantico();
+void destruir_analisador_semantico(ContextoCompilador* ctx);
 
 /**
  * @brief Adiciona uma função à tabela de funções declaradas.
  * @param nome Nome da função
  * @param linha Linha onde foi declarada
+ * @param coluna Coluna onde foi declarada
  */
-void adicionar_funcao_declarada(const char* nome, int linha);
+void adicionar_funcao_declarada(ContextoCompilador* ctx, const char* nome, int linha, int coluna);
 
 /**
- * @brief Marca uma função como chamada.
+ * @brief Registra uma chamada a uma função (contagem e linha da chamada).
  * @param nome Nome da função
+ * @param linha Linha onde ocorreu a chamada
  */
-void marcar_funcao_chamada(const char* nome);
+void marcar_funcao_chamada(ContextoCompilador* ctx, const char* nome, int linha);
 
 /**
  * @brief Verifica se uma variável foi declarada.
  * @param nome_variavel Nome da variável
  * @param linha Linha atual
+ * @param coluna Coluna atual
  * @return 1 se declarada, 0 caso contrário
  */
-int verificar_variavel_declarada(const char* nome_variavel, int linha);
+int verificar_variavel_declarada(ContextoCompilador* ctx, const char* nome_variavel, int linha, int coluna);
 
 /**
  * @brief Verifica se uma função foi declarada.
  * @param nome_funcao Nome da função
  * @param linha Linha atual
+ * @param coluna Coluna atual
  * @return 1 se declarada, 0 caso contrário
  */
-int verificar_funcao_declarada(const char* nome_funcao, int linha);
+int verificar_funcao_declarada(ContextoCompilador* ctx, const char* nome_funcao, int linha, int coluna);
 
 /**
  * @brief Verifica compatibilidade de tipos em atribuição.
  * @param nome_variavel Nome da variável
  * @param tipo_valor Tipo do valor sendo atribuído
  * @param linha Linha atual
+ * @param coluna Coluna atual
  * @return 1 se compatível, 0 caso contrário
  */
-int verificar_atribuicao_tipos(const char* nome_variavel, TipoDado tipo_valor, int linha);
+int verificar_atribuicao_tipos(ContextoCompilador* ctx, const char* nome_variavel, TipoDado tipo_valor, int linha, int coluna);
 
 /**
  * @brief Verifica compatibilidade de tipos em comparação.
@@ -375,9 +971,10 @@ int verificar_atribuicao_tipos(const char* nome_variavel, TipoDado tipo_valor, i
  * @param tipo2 Tipo do segundo operando
  * @param operador Operador de comparação
  * @param linha Linha atual
+ * @param coluna Coluna atual
  * @return 1 se compatível, 0 caso contrário
  */
-int verificar_comparacao_tipos(TipoDado tipo1, TipoDado tipo2, const char* operador, int linha);
+int verificar_comparacao_tipos(ContextoCompilador* ctx, TipoDado tipo1, TipoDado tipo2, const char* operador, int linha, int coluna);
 
 /**
  * @brief Analisa semânticamente uma atribuição.
@@ -385,8 +982,9 @@ int verificar_comparacao_tipos(TipoDado tipo1, TipoDado tipo2, const char* opera
  * @param valor Valor sendo atribuído
  * @param tipo_valor Tipo do token do valor
  * @param linha Linha atual
+ * @param coluna Coluna atual
  */
-void analisar_semantica_atribuicao(const char* nome_variavel, const char* valor, TipoToken tipo_valor, int linha);
+void analisar_semantica_atribuicao(ContextoCompilador* ctx, const char* nome_variavel, const char* valor, TipoToken tipo_valor, int linha, int coluna);
 
 /**
  * @brief Analisa semânticamente uma comparação.
@@ -396,14 +994,255 @@ void analisar_semantica_atribuicao(const char* nome_variavel, const char* valor,
  * @param tipo2 Tipo do segundo operando
  * @param operador Operador de comparação
  * @param linha Linha atual
+ * @param coluna Coluna atual
  */
-void analisar_semantica_comparacao(const char* operando1, TipoToken tipo1,
+void analisar_semantica_comparacao(ContextoCompilador* ctx, const char* operando1, TipoToken tipo1,
                                    const char* operando2, TipoToken tipo2,
-                                   const char* operador, int linha);
+                                   const char* operador, int linha, int coluna);
+
+/**
+ * @brief Avalia as verificações semânticas adiadas e emite seus alertas.
+ *
+ * Com ctx->escalonador definido e um programa grande o bastante, o parser só
+ * registra as verificações de variáveis, atribuições e comparações; elas são avaliadas em paralelo, uma
+ * tarefa por grupo de funções, e os alertas saem na ordem do código. O parser
+ * chama esta função antes de cada erro sintático e ao fim do programa. Fora
+ * do modo adiado, não faz nada.
+ */
+void concluir_verificacoes_semanticas(ContextoCompilador* ctx);
+
+/**
+ * @brief Verifica funções não utilizadas e exibe relatório, incluindo as funções mais chamadas.
+ */
+void exibir_relatorio_semantico(ContextoCompilador* ctx);
+
+/* --- CONTEXTO DE COMPILAÇÃO --- */
+
+struct TabelaFuncoes;     /* Registro de funções, interno ao analisador semântico. */
+struct VerificacoesAdiadas; /* Verificações à espera de avaliação, internas ao analisador semântico. */
+struct KernelsVarredura;  /* Versão das varreduras vetorizadas, interna ao analisador léxico. */
+struct Escalonador;       /* Escalonador de tarefas (ver ESCALONADOR DE TAREFAS). */
+
+#define TAMANHO_MENSAGEM_ERRO_LEXICO 512
+
+struct ContextoCompilador {
+    /* Saídas: listagens e relatórios vão para 'saida'; erros e alertas, para 'erros'. */
+    FILE* saida;
+    FILE* erros;
+
+    ControleMemoria memoria;
+
+    /* Threads para paralelizar fases de um mesmo arquivo; NULL: tudo na thread atual. */
+    struct Escalonador* escalonador;
+
+    /* Analisador léxico */
+    FonteBuffer fonte;
+    FluxoTokens* fluxo_tokens;
+    TabelaNomes* tabela_nomes;
+    const struct KernelsVarredura* varredura;
+    char mensagem_erro_lexico[TAMANHO_MENSAGEM_ERRO_LEXICO];  /* Último token de erro de obter_proximo_token(). */
+
+    /* Analisador sintático */
+    Token token_atual;
+    Token token_anterior;      /* Último token consumido: posição exata de delimitadores já aceitos. */
+    int posicao_token;         /* Índice de token_atual em fluxo_tokens. */
+    JanelaTokens janela;       /* token_atual e os seguintes, montados uma vez cada. */
+    int erro_sintatico_encontrado;
+    int erros_sintaticos;      /* Erros exibidos; ao atingir o limite a análise é interrompida. */
+    int posicao_ultimo_erro;   /* Token do último erro: erros seguintes no mesmo token são cascata. */
+    int profundidade_aninhamento; /* Expressões e corpos de comando abertos (ver LIMITE_ANINHAMENTO). */
+    int modulo_principal_encontrado;
+    TabelaSimbolos* tabela_simbolos;
+    PoolObjetos pool_entradas; /* Entradas da tabela, lado a lado em slabs da região sintática. */
+    PilhaBalanceamento* pilha_balanceamento;
+    PilhaOperacoes operacoes_direita; /* Sequências associativas à direita em montagem. */
+    ArvoreSintatica* arvore;   /* Produzida por analisar_programa(). */
+
+    /* Analisador semântico */
+    int erro_semantico_encontrado;
+    int alerta_semantico_emitido;
+    struct TabelaFuncoes* tabela_funcoes;
+    struct VerificacoesAdiadas* verificacoes_adiadas; /* NULL: verificações avaliadas na hora. */
+    PoolObjetos pool_funcoes;  /* Nós de função, lado a lado em slabs da região semântica. */
+};
+
+/**
+ * @brief Prepara um contexto vazio, com o orçamento de memória padrão e saídas
+ * em stdout e stderr.
+ *
+ * O contexto não guarda referências a outros contextos: compilações em threads
+ * diferentes só compartilham tabelas constantes.
+ * @param ctx O contexto a ser inicializado.
+ */
+void inicializar_contexto(ContextoCompilador* ctx);
+
+/**
+ * @brief Libera tudo o que a compilação reservou no contexto.
+ *
+ * Funciona mesmo se a compilação foi interrompida no meio de uma fase. Os
+ * contadores de memória são preservados para exibir_status_memoria().
+ * @param ctx O contexto a ser liberado.
+ */
+void destruir_contexto(ContextoCompilador* ctx);
+
+/* --- ESCALONADOR DE TAREFAS --- */
+
+/**
+ * @struct Escalonador
+ * @brief Grupo de threads trabalhadoras com roubo de tarefas (definido em escalonador.c).
+ *
+ * Cada trabalhador tem uma fila dupla própria: executa as tarefas que criou
+ * pela ponta mais recente e, quando fica ocioso, rouba a ponta mais antiga
+ * das filas alheias. Tarefas submetidas de fora dos trabalhadores entram em
+ * uma fila de injeção comum, atendida em ordem de chegada.
+ */
+typedef struct Escalonador Escalonador;
+
+/* Corpo de uma tarefa; pode submeter novas tarefas e aguardar grupos. */
+typedef void (*FuncaoTarefa)(void* argumento);
+
+/**
+ * @struct GrupoTarefas
+ * @brief Conjunto de tarefas que pode ser aguardado; o contador é protegido pelo escalonador.
+ */
+typedef struct {
+    int pendentes;
+} GrupoTarefas;
+
+/**
+ * @brief Cria o escalonador e inicia suas threads trabalhadoras.
+ * @param total_trabalhadores Número de threads desejado (pode ser 0).
+ * @return O escalonador, ou NULL se não houver memória. Menos threads podem
+ * ter sido iniciadas (ver total_trabalhadores_escalonador()).
+ */
+Escalonador* criar_escalonador(int total_trabalhadores);
+
+/**
+ * @brief Retorna quantas threads trabalhadoras estão em execução.
+ */
+int total_trabalhadores_escalonador(const Escalonador* escalonador);
+
+/**
+ * @brief Prepara um grupo sem tarefas pendentes.
+ */
+void inicializar_grupo_tarefas(GrupoTarefas* grupo);
+
+/**
+ * @brief Enfileira uma tarefa. Chamada de dentro de uma tarefa, entra na
+ * fila do trabalhador atual; caso contrário, na fila de injeção.
+ * @param grupo Grupo ao qual a tarefa pertence, ou NULL.
+ */
+void submeter_tarefa(Escalonador* escalonador, GrupoTarefas* grupo, FuncaoTarefa funcao, void* argumento);
+
+/**
+ * @brief Retorna quando todas as tarefas do grupo terminaram.
+ *
+ * Enquanto aguarda, a thread executa tarefas pendentes, de modo que uma
+ * tarefa pode aguardar as subtarefas que criou sem ocupar um trabalhador à toa
+ * e a thread principal trabalha mesmo quando nenhuma thread pôde ser criada.
+ */
+void aguardar_grupo_tarefas(Escalonador* escalonador, GrupoTarefas* grupo);
+
+/**
+ * @brief Soma as tarefas executadas e as roubadas de outras filas.
+ */
+void estatisticas_escalonador(Escalonador* escalonador, long* executadas, long* roubadas);
 
 /**
- * @brief Verifica funções não utilizadas e exibe relatório.
+ * @brief Encerra as threads, depois de esvaziadas as filas, e libera o escalonador.
+ */
+void destruir_escalonador(Escalonador* escalonador);
+
+/* --- COMPILAÇÃO EM LOTE --- */
+
+/* Extensão dos arquivos coletados ao percorrer diretórios. */
+#define EXTENSAO_FONTE ".txt"
+
+/**
+ * @struct OpcoesCompilacao
+ * @brief Opções da linha de comando aplicadas a cada arquivo compilado.
+ */
+typedef struct {
+    long limite_memoria_kb;  /* 0: ambiente ou padrão (ver configurar_orcamento_memoria()). */
+    int percentual_alerta;   /* 0: ambiente ou padrão. */
+    int total_threads;       /* 0: uma thread por núcleo. */
+} OpcoesCompilacao;
+
+/**
+ * @struct ListaFontes
+ * @brief Caminhos dos arquivos a compilar, na ordem em que serão exibidos.
+ */
+typedef struct {
+    char** caminhos;
+    int total;
+    int capacidade;
+} ListaFontes;
+
+/**
+ * @brief Compila um arquivo no contexto: análises léxica, sintática e
+ * semântica e relatório de memória, escritos em ctx->saida e ctx->erros.
+ *
+ * Ao retornar, tudo o que a compilação reservou já foi liberado.
+ * @param ctx Contexto recém-inicializado, com orçamento e saídas definidos.
+ * @param caminho Caminho do arquivo-fonte.
+ * @return 0 se o programa está correto, 1 se houve erro.
+ */
+int compilar_arquivo(ContextoCompilador* ctx, const char* caminho);
+
+/**
+ * @brief Primeira etapa de compilar_arquivo(): abre o fonte e exibe a análise léxica.
+ *
+ * As etapas podem rodar em threads diferentes, cada uma com sua própria
+ * recuperação de orçamento esgotado.
+ * @return 1 se a etapa sintática deve seguir; 0 se a compilação terminou com
+ * erro, já com o contexto destruído e o relatório de memória exibido.
+ */
+int compilar_etapa_lexica(ContextoCompilador* ctx, const char* caminho);
+
+/**
+ * @brief Segunda etapa de compilar_arquivo(): análises sintática e semântica,
+ * limpeza do contexto e relatório de memória.
+ * @return 0 se o programa está correto, 1 se houve erro.
+ */
+int compilar_etapa_sintatica(ContextoCompilador* ctx);
+
+/**
+ * @brief Prepara uma lista de fontes vazia.
+ * @param lista A lista a ser inicializada.
+ */
+void inicializar_lista_fontes(ListaFontes* lista);
+
+/**
+ * @brief Acrescenta um caminho à lista; diretórios são percorridos
+ * recursivamente em busca de arquivos com EXTENSAO_FONTE.
+ * @param lista A lista de destino.
+ * @param caminho Arquivo ou diretório.
+ * @return 1 se bem-sucedida, 0 se erro.
+ */
+int coletar_fontes(ListaFontes* lista, const char* caminho);
+
+/**
+ * @brief Libera os caminhos da lista.
+ * @param lista A lista a ser liberada.
+ */
+void liberar_lista_fontes(ListaFontes* lista);
+
+/**
+ * @brief Retorna quantos núcleos de processamento estão disponíveis.
+ */
+int total_nucleos();
+
+/**
+ * @brief Compila vários arquivos em um escalonador com roubo de tarefas.
+ *
+ * Cada arquivo tem o próprio contexto e vira uma tarefa léxica seguida de uma
+ * sintática; os maiores arquivos são submetidos primeiro. As saídas são
+ * guardadas em arquivos temporários e exibidas na ordem da lista, seguidas de
+ * um resumo.
+ * @param fontes Os arquivos a compilar.
+ * @param opcoes Orçamento de memória e número de threads.
+ * @return 0 se todos os arquivos estão corretos, 1 caso contrário.
  */
-void exibir_relatorio_semantico();
+int compilar_lote(const ListaFontes* fontes, const OpcoesCompilacao* opcoes);
 
 #endif
\ No newline at end of file
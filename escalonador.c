@@ -0,0 +1,300 @@
+/**
+ * @author Heitor Barreto e Vinícius Lopes
+ * @date Julho de 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "compilador.h"
+
+/* --- ESCALONADOR DE TAREFAS --- */
+
+typedef struct {
+    FuncaoTarefa funcao;
+    void* argumento;
+    GrupoTarefas* grupo;
+} Tarefa;
+
+/*
+ * Fila dupla circular de tarefas. O dono empilha e desempilha pelo fim (a
+ * tarefa mais recente, ainda quente na cache); os ladrões retiram do início,
+ * onde estão as tarefas mais antigas e, em geral, maiores.
+ */
+typedef struct {
+    Tarefa* tarefas;
+    int capacidade;
+    int inicio;
+    int total;
+    pthread_mutex_t trava;
+} FilaTarefas;
+
+typedef struct {
+    Escalonador* escalonador;
+    FilaTarefas fila;
+    pthread_t thread;
+    unsigned int semente;     /* Escolha da primeira vítima de cada roubo. */
+    long executadas;
+    long roubadas;
+} Trabalhador;
+
+struct Escalonador {
+    Trabalhador* trabalhadores;
+    int total_trabalhadores;  /* Filas criadas; percorridas nos roubos. */
+    int threads_iniciadas;    /* Trabalhadores [0, threads_iniciadas) têm thread própria. */
+    FilaTarefas injecao;      /* Tarefas submetidas de fora dos trabalhadores. */
+    pthread_key_t chave_trabalhador;
+    pthread_mutex_t trava;    /* Protege os campos abaixo e os contadores dos grupos. */
+    pthread_cond_t sinal;     /* Há tarefa nova, um grupo terminou ou o escalonador encerra. */
+    int disponiveis;          /* Tarefas enfileiradas e ainda não retiradas (pode ficar negativo por um instante). */
+    int encerrar;
+    long executadas_externas; /* Executadas por threads de fora enquanto aguardavam. */
+};
+
+static int inicializar_fila(FilaTarefas* fila) {
+    fila->capacidade = 64;
+    fila->inicio = 0;
+    fila->total = 0;
+    fila->tarefas = (Tarefa*) malloc(sizeof(Tarefa) * fila->capacidade);
+    if (fila->tarefas == NULL) return 0;
+    pthread_mutex_init(&fila->trava, NULL);
+    return 1;
+}
+
+static void destruir_fila(FilaTarefas* fila) {
+    pthread_mutex_destroy(&fila->trava);
+    free(fila->tarefas);
+    fila->tarefas = NULL;
+}
+
+/* Enfileira no fim; a capacidade dobra quando a fila enche. */
+static void fila_empurrar(FilaTarefas* fila, Tarefa tarefa) {
+    pthread_mutex_lock(&fila->trava);
+    if (fila->total == fila->capacidade) {
+        int nova_capacidade = fila->capacidade * 2;
+        Tarefa* novas = (Tarefa*) malloc(sizeof(Tarefa) * nova_capacidade);
+        if (novas == NULL) {
+            pthread_mutex_unlock(&fila->trava);
+            fprintf(stderr, "ERRO FATAL: Memória insuficiente para a fila de tarefas.\n");
+            exit(1);
+        }
+        for (int i = 0; i < fila->total; i++) {
+            novas[i] = fila->tarefas[(fila->inicio + i) % fila->capacidade];
+        }
+        free(fila->tarefas);
+        fila->tarefas = novas;
+        fila->capacidade = nova_capacidade;
+        fila->inicio = 0;
+    }
+    fila->tarefas[(fila->inicio + fila->total) % fila->capacidade] = tarefa;
+    fila->total++;
+    pthread_mutex_unlock(&fila->trava);
+}
+
+/* Retira do fim (dono) ou do início (ladrões e fila de injeção). */
+static int fila_retirar(FilaTarefas* fila, int do_fim, Tarefa* tarefa) {
+    pthread_mutex_lock(&fila->trava);
+    if (fila->total == 0) {
+        pthread_mutex_unlock(&fila->trava);
+        return 0;
+    }
+    if (do_fim) {
+        *tarefa = fila->tarefas[(fila->inicio + fila->total - 1) % fila->capacidade];
+    } else {
+        *tarefa = fila->tarefas[fila->inicio];
+        fila->inicio = (fila->inicio + 1) % fila->capacidade;
+    }
+    fila->total--;
+    pthread_mutex_unlock(&fila->trava);
+    return 1;
+}
+
+/* Gerador xorshift de 32 bits, suficiente para espalhar os roubos. */
+static unsigned int proxima_vitima(Trabalhador* trabalhador, int total) {
+    unsigned int x = trabalhador->semente;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    trabalhador->semente = x;
+    return x % (unsigned int) total;
+}
+
+/*
+ * Procura uma tarefa para a thread atual: primeiro a própria fila, depois a
+ * fila de injeção e por fim as filas dos outros trabalhadores, a partir de
+ * uma vítima aleatória.
+ */
+static int obter_tarefa(Escalonador* escalonador, Trabalhador* trabalhador, Tarefa* tarefa) {
+    int encontrada = 0;
+    if (trabalhador != NULL && fila_retirar(&trabalhador->fila, 1, tarefa)) {
+        encontrada = 1;
+    } else if (fila_retirar(&escalonador->injecao, 0, tarefa)) {
+        encontrada = 1;
+    } else if (escalonador->total_trabalhadores > 0) {
+        int total = escalonador->total_trabalhadores;
+        int vitima = trabalhador != NULL ? (int) proxima_vitima(trabalhador, total) : 0;
+        for (int i = 0; i < total && !encontrada; i++) {
+            Trabalhador* alvo = &escalonador->trabalhadores[(vitima + i) % total];
+            if (alvo != trabalhador && fila_retirar(&alvo->fila, 0, tarefa)) {
+                encontrada = 1;
+                if (trabalhador != NULL) trabalhador->roubadas++;
+            }
+        }
+    }
+    if (encontrada) {
+        pthread_mutex_lock(&escalonador->trava);
+        escalonador->disponiveis--;
+        pthread_mutex_unlock(&escalonador->trava);
+    }
+    return encontrada;
+}
+
+static void executar_tarefa(Escalonador* escalonador, Trabalhador* trabalhador, Tarefa* tarefa) {
+    tarefa->funcao(tarefa->argumento);
+
+    pthread_mutex_lock(&escalonador->trava);
+    if (trabalhador != NULL) {
+        trabalhador->executadas++;
+    } else {
+        escalonador->executadas_externas++;
+    }
+    if (tarefa->grupo != NULL && --tarefa->grupo->pendentes == 0) {
+        pthread_cond_broadcast(&escalonador->sinal);
+    }
+    pthread_mutex_unlock(&escalonador->trava);
+}
+
+static void* executar_trabalhador(void* argumento) {
+    Trabalhador* trabalhador = (Trabalhador*) argumento;
+    Escalonador* escalonador = trabalhador->escalonador;
+    pthread_setspecific(escalonador->chave_trabalhador, trabalhador);
+
+    for (;;) {
+        Tarefa tarefa;
+        if (obter_tarefa(escalonador, trabalhador, &tarefa)) {
+            executar_tarefa(escalonador, trabalhador, &tarefa);
+            continue;
+        }
+        pthread_mutex_lock(&escalonador->trava);
+        while (!escalonador->encerrar && escalonador->disponiveis <= 0) {
+            pthread_cond_wait(&escalonador->sinal, &escalonador->trava);
+        }
+        int encerrar = escalonador->encerrar && escalonador->disponiveis <= 0;
+        pthread_mutex_unlock(&escalonador->trava);
+        if (encerrar) break;
+    }
+    return NULL;
+}
+
+Escalonador* criar_escalonador(int total_trabalhadores) {
+    Escalonador* escalonador = (Escalonador*) calloc(1, sizeof(Escalonador));
+    if (escalonador == NULL) return NULL;
+    if (total_trabalhadores < 0) total_trabalhadores = 0;
+    escalonador->trabalhadores = (Trabalhador*) calloc((size_t) (total_trabalhadores > 0 ? total_trabalhadores : 1), sizeof(Trabalhador));
+    if (escalonador->trabalhadores == NULL || !inicializar_fila(&escalonador->injecao)) {
+        free(escalonador->trabalhadores);
+        free(escalonador);
+        return NULL;
+    }
+    pthread_key_create(&escalonador->chave_trabalhador, NULL);
+    pthread_mutex_init(&escalonador->trava, NULL);
+    pthread_cond_init(&escalonador->sinal, NULL);
+
+    /* As filas existem antes de qualquer thread, pois todas podem ser roubadas. */
+    int filas = 0;
+    while (filas < total_trabalhadores && inicializar_fila(&escalonador->trabalhadores[filas].fila)) {
+        Trabalhador* trabalhador = &escalonador->trabalhadores[filas];
+        trabalhador->escalonador = escalonador;
+        trabalhador->semente = 2654435761u * (unsigned int) (filas + 1);
+        filas++;
+    }
+
+    /* Trabalhadores cuja thread não pôde ser criada ficam com a fila vazia; quem aguarda executa o restante. */
+    escalonador->total_trabalhadores = filas;
+    while (escalonador->threads_iniciadas < filas &&
+           pthread_create(&escalonador->trabalhadores[escalonador->threads_iniciadas].thread, NULL,
+                          executar_trabalhador, &escalonador->trabalhadores[escalonador->threads_iniciadas]) == 0) {
+        escalonador->threads_iniciadas++;
+    }
+    return escalonador;
+}
+
+int total_trabalhadores_escalonador(const Escalonador* escalonador) {
+    return escalonador->threads_iniciadas;
+}
+
+void inicializar_grupo_tarefas(GrupoTarefas* grupo) {
+    grupo->pendentes = 0;
+}
+
+void submeter_tarefa(Escalonador* escalonador, GrupoTarefas* grupo, FuncaoTarefa funcao, void* argumento) {
+    Tarefa tarefa = {funcao, argumento, grupo};
+    Trabalhador* trabalhador = (Trabalhador*) pthread_getspecific(escalonador->chave_trabalhador);
+
+    pthread_mutex_lock(&escalonador->trava);
+    if (grupo != NULL) grupo->pendentes++;
+    pthread_mutex_unlock(&escalonador->trava);
+
+    /* Subtarefas ficam na fila de quem as criou; as demais vão para a fila de injeção. */
+    fila_empurrar(trabalhador != NULL ? &trabalhador->fila : &escalonador->injecao, tarefa);
+
+    pthread_mutex_lock(&escalonador->trava);
+    escalonador->disponiveis++;
+    pthread_cond_signal(&escalonador->sinal);
+    pthread_mutex_unlock(&escalonador->trava);
+}
+
+void aguardar_grupo_tarefas(Escalonador* escalonador, GrupoTarefas* grupo) {
+    Trabalhador* trabalhador = (Trabalhador*) pthread_getspecific(escalonador->chave_trabalhador);
+    for (;;) {
+        pthread_mutex_lock(&escalonador->trava);
+        int pendentes = grupo->pendentes;
+        pthread_mutex_unlock(&escalonador->trava);
+        if (pendentes == 0) return;
+
+        /* Em vez de bloquear, quem aguarda ajuda a esvaziar as filas. */
+        Tarefa tarefa;
+        if (obter_tarefa(escalonador, trabalhador, &tarefa)) {
+            executar_tarefa(escalonador, trabalhador, &tarefa);
+            continue;
+        }
+        pthread_mutex_lock(&escalonador->trava);
+        while (grupo->pendentes > 0 && escalonador->disponiveis <= 0) {
+            pthread_cond_wait(&escalonador->sinal, &escalonador->trava);
+        }
+        pthread_mutex_unlock(&escalonador->trava);
+    }
+}
+
+void estatisticas_escalonador(Escalonador* escalonador, long* executadas, long* roubadas) {
+    pthread_mutex_lock(&escalonador->trava);
+    *executadas = escalonador->executadas_externas;
+    *roubadas = 0;
+    for (int i = 0; i < escalonador->total_trabalhadores; i++) {
+        *executadas += escalonador->trabalhadores[i].executadas;
+        *roubadas += escalonador->trabalhadores[i].roubadas;
+    }
+    pthread_mutex_unlock(&escalonador->trava);
+}
+
+void destruir_escalonador(Escalonador* escalonador) {
+    if (escalonador == NULL) return;
+    pthread_mutex_lock(&escalonador->trava);
+    escalonador->encerrar = 1;
+    pthread_cond_broadcast(&escalonador->sinal);
+    pthread_mutex_unlock(&escalonador->trava);
+
+    for (int i = 0; i < escalonador->threads_iniciadas; i++) {
+        pthread_join(escalonador->trabalhadores[i].thread, NULL);
+    }
+    for (int i = 0; i < escalonador->total_trabalhadores; i++) {
+        destruir_fila(&escalonador->trabalhadores[i].fila);
+    }
+    destruir_fila(&escalonador->injecao);
+    pthread_cond_destroy(&escalonador->sinal);
+    pthread_mutex_destroy(&escalonador->trava);
+    pthread_key_delete(escalonador->chave_trabalhador);
+    free(escalonador->trabalhadores);
+    free(escalonador);
+}
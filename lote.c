@@ -0,0 +1,372 @@
+/**
+ * @author Heitor Barreto e Vinícius Lopes
+ * @date Julho de 2025
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "compilador.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/* --- COMPILAÇÃO DE UM ARQUIVO --- */
+
+/* Encerra uma etapa interrompida por orçamento esgotado. */
+static int abortar_por_memoria(ContextoCompilador* ctx) {
+    ctx->memoria.recuperacao = NULL;
+    fflush(ctx->saida);
+    fprintf(ctx->erros, "\nCompilação interrompida: orçamento de memória esgotado.\n");
+    destruir_contexto(ctx);
+    exibir_status_memoria(ctx);
+    return 1;
+}
+
+int compilar_etapa_lexica(ContextoCompilador* ctx, const char* caminho) {
+    if (!abrir_fonte(ctx, caminho)) {
+        fprintf(ctx->erros, "Erro ao abrir o arquivo '%s': %s\n", caminho, strerror(errno));
+        return 0;
+    }
+
+    /* Se o orçamento de memória se esgotar, alocar_memoria() volta para cá em vez de encerrar o processo. */
+    jmp_buf recuperacao;
+    if (setjmp(recuperacao) != 0) {
+        abortar_por_memoria(ctx);
+        return 0;
+    }
+    ctx->memoria.recuperacao = &recuperacao;
+
+    /* --- ETAPA 1: EXIBIÇÃO DA ANÁLISE LÉXICA --- */
+    fprintf(ctx->saida, "=== ANÁLISE LÉXICA ===\n\n");
+    fprintf(ctx->saida, "%-10s | %-30s | %s\n", "LINHA", "TIPO DE TOKEN", "LEXEMA");
+    fprintf(ctx->saida, "-----------------------------------------------------------------\n");
+
+    /* Nomes de variáveis e funções são internados já durante a varredura. */
+    inicializar_tabela_nomes(ctx);
+
+    /* Varre o código-fonte uma única vez; o mesmo vetor alimenta o parser. */
+    int lexico_ok = gerar_tokens(ctx);
+    for (int i = 0; i < ctx->fluxo_tokens->total; i++) {
+        Token token_lexico = token_na_posicao(ctx, i);
+        fprintf(ctx->saida, "%-10d | %-30s | %s\n", token_lexico.linha, tipo_token_para_str(token_lexico.tipo), token_lexico.lexema);
+    }
+
+    // Se encontrar um erro léxico, para e não continua para o sintático.
+    if (!lexico_ok) {
+        fflush(ctx->saida); // Garante que a tabela seja impressa antes da mensagem de erro
+        fprintf(ctx->erros, "\nERRO LÉXICO: %s\n", ctx->fluxo_tokens->mensagem_erro);
+        ctx->memoria.recuperacao = NULL;
+        destruir_contexto(ctx);
+        exibir_status_memoria(ctx);
+        return 0;
+    }
+
+    fprintf(ctx->saida, "\n\n");
+    ctx->memoria.recuperacao = NULL;
+    return 1;
+}
+
+int compilar_etapa_sintatica(ContextoCompilador* ctx) {
+    /* O jmp_buf da etapa léxica pode estar na pilha de outra thread: cada etapa tem o seu. */
+    jmp_buf recuperacao;
+    if (setjmp(recuperacao) != 0) {
+        return abortar_por_memoria(ctx);
+    }
+    ctx->memoria.recuperacao = &recuperacao;
+
+    /* --- ETAPA 2: ANÁLISE SINTÁTICA --- */
+
+    fprintf(ctx->saida, "=== ANÁLISE SINTÁTICA ===\n\n");
+
+    /* Inicializa o analisador sintático */
+    inicializar_parser(ctx);
+
+    /* Realiza a análise sintática completa */
+    fprintf(ctx->saida, "Iniciando análise sintática...\n");
+    int sucesso = analisar_programa(ctx);
+
+    /* Exibe resultados */
+    if (sucesso && !ctx->erro_sintatico_encontrado) {
+        fprintf(ctx->saida, "\n✓ ANÁLISE SINTÁTICA CONCLUÍDA COM SUCESSO!\n");
+        fprintf(ctx->saida, "✓ Programa sintaticamente correto.\n");
+
+        /* Exibe tabela de símbolos APENAS se não houver erros */
+        if (ctx->tabela_simbolos && ctx->tabela_simbolos->total_entradas > 0) {
+            exibir_tabela_simbolos(ctx);
+        }
+
+        /* --- ETAPA 3: ANÁLISE SEMÂNTICA --- */
+        fprintf(ctx->saida, "\n=== ANÁLISE SEMÂNTICA ===\n\n");
+        fprintf(ctx->saida, "Executando verificações semânticas...\n");
+
+        /* Exibe relatório semântico */
+        exibir_relatorio_semantico(ctx);
+
+    } else {
+        fprintf(ctx->saida, "\n✗ ANÁLISE SINTÁTICA FALHOU!\n");
+        fprintf(ctx->saida, "✗ Erros sintáticos encontrados no programa.\n");
+    }
+
+    int status = (sucesso && !ctx->erro_sintatico_encontrado) ? 0 : 1;
+
+    /* Limpa recursos */
+    ctx->memoria.recuperacao = NULL;
+    destruir_contexto(ctx);
+
+    /* Exibe relatório de memória */
+    exibir_status_memoria(ctx);
+
+    return status;
+}
+
+int compilar_arquivo(ContextoCompilador* ctx, const char* caminho) {
+    if (!compilar_etapa_lexica(ctx, caminho)) {
+        return 1;
+    }
+    return compilar_etapa_sintatica(ctx);
+}
+
+/* --- COLETA DE ARQUIVOS --- */
+
+void inicializar_lista_fontes(ListaFontes* lista) {
+    lista->caminhos = NULL;
+    lista->total = 0;
+    lista->capacidade = 0;
+}
+
+static int adicionar_fonte(ListaFontes* lista, const char* caminho) {
+    if (lista->total == lista->capacidade) {
+        int nova_capacidade = lista->capacidade ? lista->capacidade * 2 : 16;
+        char** novos = (char**) realloc(lista->caminhos, sizeof(char*) * nova_capacidade);
+        if (novos == NULL) return 0;
+        lista->caminhos = novos;
+        lista->capacidade = nova_capacidade;
+    }
+    size_t tamanho = strlen(caminho);
+    char* copia = (char*) malloc(tamanho + 1);
+    if (copia == NULL) return 0;
+    memcpy(copia, caminho, tamanho + 1);
+    lista->caminhos[lista->total++] = copia;
+    return 1;
+}
+
+static int comparar_caminhos(const void* a, const void* b) {
+    return strcmp(*(char* const*) a, *(char* const*) b);
+}
+
+static int tem_extensao_fonte(const char* nome) {
+    size_t tamanho = strlen(nome);
+    size_t tamanho_extensao = strlen(EXTENSAO_FONTE);
+    return tamanho > tamanho_extensao && strcmp(nome + tamanho - tamanho_extensao, EXTENSAO_FONTE) == 0;
+}
+
+/* Percorre um diretório recursivamente; os arquivos de cada diretório entram em ordem alfabética. */
+static int coletar_diretorio(ListaFontes* lista, const char* diretorio) {
+    DIR* dir = opendir(diretorio);
+    if (dir == NULL) {
+        fprintf(stderr, "Erro ao abrir o diretório '%s': %s\n", diretorio, strerror(errno));
+        return 0;
+    }
+
+    int primeiro = lista->total;
+    int ok = 1;
+    struct dirent* entrada;
+    while (ok && (entrada = readdir(dir)) != NULL) {
+        if (strcmp(entrada->d_name, ".") == 0 || strcmp(entrada->d_name, "..") == 0) continue;
+        char caminho[4096];
+        snprintf(caminho, sizeof(caminho), "%s/%s", diretorio, entrada->d_name);
+
+        struct stat info;
+        if (stat(caminho, &info) != 0) continue;
+        if (S_ISDIR(info.st_mode)) {
+            ok = coletar_diretorio(lista, caminho);
+        } else if (S_ISREG(info.st_mode) && tem_extensao_fonte(entrada->d_name)) {
+            ok = adicionar_fonte(lista, caminho);
+        }
+    }
+    closedir(dir);
+
+    /* Ordem determinística: readdir não garante nenhuma. */
+    qsort(lista->caminhos + primeiro, lista->total - primeiro, sizeof(char*), comparar_caminhos);
+    return ok;
+}
+
+int coletar_fontes(ListaFontes* lista, const char* caminho) {
+    struct stat info;
+    if (stat(caminho, &info) == 0 && S_ISDIR(info.st_mode)) {
+        return coletar_diretorio(lista, caminho);
+    }
+    /* Arquivos inexistentes seguem adiante: o erro é relatado na compilação, em ordem. */
+    return adicionar_fonte(lista, caminho);
+}
+
+void liberar_lista_fontes(ListaFontes* lista) {
+    for (int i = 0; i < lista->total; i++) {
+        free(lista->caminhos[i]);
+    }
+    free(lista->caminhos);
+    inicializar_lista_fontes(lista);
+}
+
+/* --- COMPILAÇÃO EM LOTE --- */
+
+/* Resultado de um arquivo: as saídas ficam em arquivos temporários até chegar sua vez de ser exibido. */
+typedef struct {
+    const char* caminho;
+    long tamanho;                /* Em bytes; os maiores arquivos são submetidos primeiro. */
+    const OpcoesCompilacao* opcoes;
+    Escalonador* escalonador;
+    ContextoCompilador* ctx;     /* Vive entre a tarefa léxica e a sintática. */
+    GrupoTarefas grupo;          /* Tarefas do arquivo ainda não concluídas. */
+    FILE* saida;
+    FILE* erros;
+    int status;
+} ResultadoArquivo;
+
+int total_nucleos() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int) info.dwNumberOfProcessors;
+#else
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    return nucleos > 0 ? (int) nucleos : 1;
+#endif
+}
+
+static void tarefa_etapa_sintatica(void* argumento) {
+    ResultadoArquivo* resultado = (ResultadoArquivo*) argumento;
+    resultado->status = compilar_etapa_sintatica(resultado->ctx);
+    free(resultado->ctx);
+    resultado->ctx = NULL;
+}
+
+/* Primeira tarefa de cada arquivo; se o léxico passar, encadeia a sintática no mesmo grupo. */
+static void tarefa_etapa_lexica(void* argumento) {
+    ResultadoArquivo* resultado = (ResultadoArquivo*) argumento;
+    resultado->status = 1;
+    resultado->saida = tmpfile();
+    resultado->erros = tmpfile();
+    if (resultado->saida == NULL || resultado->erros == NULL) {
+        /* despejar_temporario() ignora o que não pôde ser criado. */
+        fprintf(resultado->erros ? resultado->erros : stderr,
+                "Erro ao criar arquivo temporário para '%s': %s\n", resultado->caminho, strerror(errno));
+        return;
+    }
+
+    /* O contexto fica no heap: a etapa sintática pode rodar em outra thread. */
+    resultado->ctx = (ContextoCompilador*) malloc(sizeof(ContextoCompilador));
+    if (resultado->ctx == NULL) {
+        fprintf(resultado->erros, "ERRO FATAL: Memória insuficiente para compilar '%s'.\n", resultado->caminho);
+        return;
+    }
+    ContextoCompilador* ctx = resultado->ctx;
+    inicializar_contexto(ctx);
+    ctx->saida = resultado->saida;
+    ctx->erros = resultado->erros;
+    /* Com --threads explícito, as fases de um arquivo grande também viram tarefas roubáveis. */
+    ctx->escalonador = resultado->opcoes->total_threads > 1 ? resultado->escalonador : NULL;
+    configurar_orcamento_memoria(ctx, resultado->opcoes->limite_memoria_kb, resultado->opcoes->percentual_alerta);
+    configurar_perfil_memoria(ctx);
+
+    if (compilar_etapa_lexica(ctx, resultado->caminho)) {
+        submeter_tarefa(resultado->escalonador, &resultado->grupo, tarefa_etapa_sintatica, resultado);
+    } else {
+        free(resultado->ctx);
+        resultado->ctx = NULL;
+    }
+}
+
+/* Ordena por tamanho decrescente, mantendo a ordem da lista entre iguais. */
+static int comparar_tamanhos(const void* a, const void* b) {
+    const ResultadoArquivo* ra = *(ResultadoArquivo* const*) a;
+    const ResultadoArquivo* rb = *(ResultadoArquivo* const*) b;
+    if (ra->tamanho != rb->tamanho) return ra->tamanho < rb->tamanho ? 1 : -1;
+    return ra < rb ? -1 : (ra > rb);
+}
+
+/* Copia um arquivo temporário para o destino e o fecha. */
+static void despejar_temporario(FILE* temporario, FILE* destino) {
+    if (temporario == NULL) return;
+    char buffer[8192];
+    size_t lidos;
+    rewind(temporario);
+    while ((lidos = fread(buffer, 1, sizeof(buffer), temporario)) > 0) {
+        fwrite(buffer, 1, lidos, destino);
+    }
+    fclose(temporario);
+    fflush(destino);
+}
+
+int compilar_lote(const ListaFontes* fontes, const OpcoesCompilacao* opcoes) {
+    int total_threads = opcoes->total_threads > 0 ? opcoes->total_threads : total_nucleos();
+    if (total_threads > fontes->total) {
+        total_threads = fontes->total;
+    }
+
+    ResultadoArquivo* resultados = (ResultadoArquivo*) calloc((size_t) fontes->total, sizeof(ResultadoArquivo));
+    ResultadoArquivo** ordem = (ResultadoArquivo**) malloc(sizeof(ResultadoArquivo*) * fontes->total);
+    /* A thread principal também executa tarefas enquanto aguarda, então cria-se uma thread a menos. */
+    Escalonador* escalonador = (resultados && ordem) ? criar_escalonador(total_threads - 1) : NULL;
+    if (escalonador == NULL) {
+        fprintf(stderr, "ERRO FATAL: Memória insuficiente para o lote de %d arquivos.\n", fontes->total);
+        free(resultados);
+        free(ordem);
+        return 1;
+    }
+
+    for (int i = 0; i < fontes->total; i++) {
+        ResultadoArquivo* resultado = &resultados[i];
+        struct stat info;
+        resultado->caminho = fontes->caminhos[i];
+        resultado->tamanho = stat(resultado->caminho, &info) == 0 ? (long) info.st_size : 0;
+        resultado->opcoes = opcoes;
+        resultado->escalonador = escalonador;
+        inicializar_grupo_tarefas(&resultado->grupo);
+        ordem[i] = resultado;
+    }
+
+    /* Maiores primeiro: um arquivo enorme no fim da fila deixaria as demais threads ociosas enquanto termina. */
+    qsort(ordem, (size_t) fontes->total, sizeof(ResultadoArquivo*), comparar_tamanhos);
+    for (int i = 0; i < fontes->total; i++) {
+        submeter_tarefa(escalonador, &ordem[i]->grupo, tarefa_etapa_lexica, ordem[i]);
+    }
+
+    /* Exibe cada arquivo assim que ele e todos os anteriores terminaram: a saída segue a ordem de entrada. */
+    int com_erro = 0;
+    for (int i = 0; i < fontes->total; i++) {
+        ResultadoArquivo* resultado = &resultados[i];
+        aguardar_grupo_tarefas(escalonador, &resultado->grupo);
+
+        printf("\n################ ARQUIVO: %s ################\n\n", resultado->caminho);
+        fflush(stdout);
+        despejar_temporario(resultado->saida, stdout);
+        despejar_temporario(resultado->erros, stderr);
+        if (resultado->status != 0) {
+            com_erro++;
+        }
+    }
+
+    long executadas, roubadas;
+    estatisticas_escalonador(escalonador, &executadas, &roubadas);
+    int threads_utilizadas = total_trabalhadores_escalonador(escalonador) + 1;
+    destruir_escalonador(escalonador);
+    free(ordem);
+    free(resultados);
+
+    printf("\n================ RESUMO DO LOTE ================\n");
+    printf("Arquivos compilados: %d\n", fontes->total);
+    printf("Arquivos com erros: %d\n", com_erro);
+    printf("Threads utilizadas: %d\n", threads_utilizadas);
+    printf("Tarefas executadas: %ld (%ld roubadas)\n", executadas, roubadas);
+    printf("================================================\n");
+
+    return com_erro > 0 ? 1 : 0;
+}
@@ -4,102 +4,96 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "compilador.h"
 #include <windows.h>
 
-int main() {
-
-    SetConsoleOutputCP(CP_UTF8);
-    SetConsoleCP(CP_UTF8);
-
-    arquivo_fonte = fopen("codigo_fonte.txt", "r");
-    if (arquivo_fonte == NULL) {
-        perror("Erro ao abrir o arquivo 'codigo_fonte.txt'");
-        return 1;
+/*
+ * Reconhece "--nome=N" ou "--nome N" em argv[*i], avançando *i no segundo caso.
+ * Retorna 1 se a opção casou com um número positivo, -1 se casou com valor inválido e 0 se não casou.
+ */
+static int ler_opcao_numerica(int argc, char* argv[], int* i, const char* nome, long* valor) {
+    size_t tamanho = strlen(nome);
+    const char* texto;
+    if (strncmp(argv[*i], nome, tamanho) != 0) {
+        return 0;
+    }
+    if (argv[*i][tamanho] == '=') {
+        texto = argv[*i] + tamanho + 1;
+    } else if (argv[*i][tamanho] == '\0' && *i + 1 < argc) {
+        texto = argv[++*i];
+    } else {
+        return argv[*i][tamanho] == '\0' ? -1 : 0;
     }
+    char* fim;
+    *valor = strtol(texto, &fim, 10);
+    return (fim != texto && *fim == '\0' && *valor > 0) ? 1 : -1;
+}
 
-    /* --- ETAPA 1: EXIBIÇÃO DA ANÁLISE LÉXICA --- */
-    printf("=== ANÁLISE LÉXICA ===\n\n");
-    printf("%-10s | %-30s | %s\n", "LINHA", "TIPO DE TOKEN", "LEXEMA");
-    printf("-----------------------------------------------------------------\n");
+int main(int argc, char* argv[]) {
 
-    Token token_lexico;
-    do {
-        token_lexico = obter_proximo_token();
-        printf("%-10d | %-30s | %s\n", token_lexico.linha, tipo_token_para_str(token_lexico.tipo), token_lexico.lexema);
+    SetConsoleOutputCP(CP_UTF8);
+    SetConsoleCP(CP_UTF8);
 
-        // Se encontrar um erro léxico, para e não continua para o sintático.
-        if (token_lexico.tipo == TOKEN_ERRO) {
-            fflush(stdout); // Garante que a tabela seja impressa antes da mensagem de erro
-            fprintf(stderr, "\nERRO LÉXICO: %s\n", token_lexico.lexema);
-            destruir_token(token_lexico);
-            fclose(arquivo_fonte);
-            exibir_status_memoria();
-            return 1; // Termina o programa com erro
+    /* Orçamento de memória: a linha de comando prevalece sobre o ambiente. */
+    long limite_kb = 0;
+    long percentual_alerta = 0;
+    long total_threads = 0;
+    int caminhos_informados = 0;
+    ListaFontes fontes;
+    inicializar_lista_fontes(&fontes);
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0) {
+            /* Argumentos que não são opções são arquivos ou diretórios a compilar. */
+            caminhos_informados++;
+            if (!coletar_fontes(&fontes, argv[i])) {
+                liberar_lista_fontes(&fontes);
+                return 1;
+            }
+            continue;
         }
-        destruir_token(token_lexico);
-    } while (token_lexico.tipo != TOKEN_FIM_DE_ARQUIVO);
-
-    printf("\n\n");
-
-    /* --- ETAPA 2: ANÁLISE SINTÁTICA --- */
-
-    // REBOBINA o arquivo e reseta a linha para o analisador sintático começar do início
-    rewind(arquivo_fonte);
-    linha_atual = 1;
-
-    printf("=== ANÁLISE SINTÁTICA ===\n\n");
-
-    /* Inicializa o analisador sintático */
-    inicializar_parser();
-
-    /* Realiza a análise sintática completa */
-    printf("Iniciando análise sintática...\n");
-    int sucesso = analisar_programa();
-
-    /* Libera o último token */
-    if (token_atual.lexema) {
-        destruir_token(token_atual);
-    }
-
-    /* Exibe resultados */
-    if (sucesso && !erro_sintatico_encontrado) {
-        printf("\n✓ ANÁLISE SINTÁTICA CONCLUÍDA COM SUCESSO!\n");
-        printf("✓ Programa sintaticamente correto.\n");
-
-        /* Exibe tabela de símbolos APENAS se não houver erros */
-        if (tabela_simbolos && tabela_simbolos->total_entradas > 0) {
-            exibir_tabela_simbolos();
+        int lido = ler_opcao_numerica(argc, argv, &i, "--memoria-kb", &limite_kb);
+        if (lido == 0) {
+            lido = ler_opcao_numerica(argc, argv, &i, "--alerta-memoria", &percentual_alerta);
+        }
+        if (lido == 0) {
+            lido = ler_opcao_numerica(argc, argv, &i, "--threads", &total_threads);
+        }
+        if (lido != 1) {
+            fprintf(stderr, "Opção inválida: '%s'\n", argv[i]);
+            fprintf(stderr, "Uso: %s [--memoria-kb N] [--alerta-memoria PERCENTUAL] [--threads N] [arquivo|diretório ...]\n", argv[0]);
+            liberar_lista_fontes(&fontes);
+            return 1;
         }
-
-        /* --- ETAPA 3: ANÁLISE SEMÂNTICA --- */
-        printf("\n=== ANÁLISE SEMÂNTICA ===\n\n");
-        printf("Executando verificações semânticas...\n");
-
-        /* Exibe relatório semântico */
-        exibir_relatorio_semantico();
-
-    } else {
-        printf("\n✗ ANÁLISE SINTÁTICA FALHOU!\n");
-        printf("✗ Erros sintáticos encontrados no programa.\n");
     }
 
-    /* Limpa recursos */
-    fclose(arquivo_fonte);
-
-    if (tabela_simbolos) {
-        destruir_tabela_simbolos();
+    /* Vários arquivos (ou um diretório): compilação em lote, um contexto por arquivo. */
+    if (caminhos_informados > 1 || fontes.total != caminhos_informados) {
+        OpcoesCompilacao opcoes = {limite_kb, (int) percentual_alerta, (int) total_threads};
+        int status = fontes.total > 0 ? compilar_lote(&fontes, &opcoes) : 0;
+        if (fontes.total == 0) {
+            fprintf(stderr, "Nenhum arquivo '%s' encontrado.\n", EXTENSAO_FONTE);
+            status = 1;
+        }
+        liberar_lista_fontes(&fontes);
+        return status;
     }
 
-    if (pilha_balanceamento) {
-        destruir_pilha_balanceamento();
-    }
+    /* Um único arquivo (por padrão 'codigo_fonte.txt') é compilado direto no terminal. */
+    ContextoCompilador contexto;
+    ContextoCompilador* ctx = &contexto;
+    inicializar_contexto(ctx);
+    configurar_orcamento_memoria(ctx, limite_kb, (int) percentual_alerta);
 
-    /* Limpa recursos semânticos */
-    destruir_analisador_semantico();
+    /* COMPILADOR_PERFIL_MEMORIA=1 detalha as alocações por categoria no relatório final. */
+    configurar_perfil_memoria(ctx);
 
-    /* Exibe relatório de memória */
-    exibir_status_memoria();
+    /* Só com --threads N (N > 1) as fases de um arquivo grande são divididas entre threads. */
+    ctx->escalonador = total_threads > 1 ? criar_escalonador((int) total_threads - 1) : NULL;
 
-    return (sucesso && !erro_sintatico_encontrado) ? 0 : 1;
-}
\ No newline at end of file
+    int status = compilar_arquivo(ctx, fontes.total == 1 ? fontes.caminhos[0] : "codigo_fonte.txt");
+    destruir_escalonador(ctx->escalonador);
+    liberar_lista_fontes(&fontes);
+    return status;
+}
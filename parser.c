@@ -3,71 +3,158 @@
  * @date Julho de 2025
  */
 
+#include <assert.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "compilador.h"
 
-/* --- VARIÁVEIS GLOBAIS DO PARSER --- */
-Token token_atual;
-int erro_sintatico_encontrado = 0;
-int modulo_principal_encontrado = 0;
+/* O estado do parser (token atual, flags de erro, tabela e pilha) fica no ContextoCompilador. */
+
+#define LIMITE_ERROS_SINTATICOS 20
+
+/*
+ * Expressões entre parênteses e corpos de 'se'/'para' são analisados por
+ * recursão; acima deste nível o aninhamento vira erro sintático em vez de
+ * esgotar a pilha da thread (cerca de 300 bytes por nível com -O2).
+ */
+#define LIMITE_ANINHAMENTO 256
+
+static int analise_interrompida(ContextoCompilador* ctx) {
+    return ctx->erros_sintaticos >= LIMITE_ERROS_SINTATICOS;
+}
+
+/*
+ * Escreve um erro sintático e marca o contexto. Alertas de verificações
+ * semânticas adiadas saem antes, para manter a ordem do código. Um erro no
+ * mesmo token do anterior é consequência dele (vários níveis desistindo da
+ * mesma construção) e não é repetido.
+ */
+static void relatar_erro_sintatico(ContextoCompilador* ctx, const char* formato, ...) {
+    ctx->erro_sintatico_encontrado = 1;
+    if (analise_interrompida(ctx) || ctx->posicao_token == ctx->posicao_ultimo_erro) return;
+
+    concluir_verificacoes_semanticas(ctx);
+
+    va_list argumentos;
+    va_start(argumentos, formato);
+    vfprintf(ctx->erros, formato, argumentos);
+    va_end(argumentos);
+    ctx->posicao_ultimo_erro = ctx->posicao_token;
+
+    if (++ctx->erros_sintaticos == LIMITE_ERROS_SINTATICOS) {
+        fprintf(ctx->erros, "ERRO SINTÁTICO: Limite de %d erros atingido; análise interrompida.\n", LIMITE_ERROS_SINTATICOS);
+    }
+}
 
 /* --- TABELA DE SÍMBOLOS --- */
-TabelaSimbolos* tabela_simbolos = NULL;
 
-void inicializar_tabela_simbolos() {
-    tabela_simbolos = (TabelaSimbolos*) alocar_memoria(sizeof(TabelaSimbolos));
-    tabela_simbolos->primeira = NULL;
-    tabela_simbolos->total_entradas = 0;
+#define CAPACIDADE_INICIAL_INDICE 64
+#define ENTRADAS_POR_SLAB 32
+
+void inicializar_tabela_simbolos(ContextoCompilador* ctx) {
+    pool_inicializar(ctx, &ctx->pool_entradas, "EntradaTabela", sizeof(EntradaTabela), ENTRADAS_POR_SLAB, REGIAO_SINTATICO);
+    ctx->tabela_simbolos = (TabelaSimbolos*) alocar_na_regiao(ctx, REGIAO_SINTATICO, sizeof(TabelaSimbolos));
+    ctx->tabela_simbolos->primeira = NULL;
+    ctx->tabela_simbolos->total_entradas = 0;
+    ctx->tabela_simbolos->capacidade_indice = CAPACIDADE_INICIAL_INDICE;
+    ctx->tabela_simbolos->indice = (EntradaTabela**) alocar_na_regiao(ctx, REGIAO_SINTATICO, sizeof(EntradaTabela*) * CAPACIDADE_INICIAL_INDICE);
+    memset(ctx->tabela_simbolos->indice, 0, sizeof(EntradaTabela*) * CAPACIDADE_INICIAL_INDICE);
+}
+
+/* Espalha ids consecutivos pela tabela (hash multiplicativo de Knuth). */
+static int slot_inicial_indice(int id_nome, int capacidade) {
+    return (int)(((unsigned int) id_nome * 2654435761u) & (unsigned int)(capacidade - 1));
 }
 
-void adicionar_variavel(const char* nome, TipoDado tipo, const char* funcao_escopo,
+static void inserir_no_indice(EntradaTabela** indice, int capacidade, EntradaTabela* entrada) {
+    int slot = slot_inicial_indice(entrada->id_nome, capacidade);
+    while (indice[slot] != NULL) {
+        slot = (slot + 1) & (capacidade - 1);
+    }
+    indice[slot] = entrada;
+}
+
+static void expandir_indice(ContextoCompilador* ctx) {
+    int nova_capacidade = ctx->tabela_simbolos->capacidade_indice * 2;
+    /* O índice antigo fica na região até o fim da fase; com a capacidade dobrando,
+     * os descartados somam menos que o índice atual. */
+    EntradaTabela** novo = (EntradaTabela**) alocar_na_regiao(ctx, REGIAO_SINTATICO, sizeof(EntradaTabela*) * nova_capacidade);
+    memset(novo, 0, sizeof(EntradaTabela*) * nova_capacidade);
+
+    for (EntradaTabela* atual = ctx->tabela_simbolos->primeira; atual != NULL; atual = atual->proxima) {
+        inserir_no_indice(novo, nova_capacidade, atual);
+    }
+
+    ctx->tabela_simbolos->indice = novo;
+    ctx->tabela_simbolos->capacidade_indice = nova_capacidade;
+}
+
+void adicionar_variavel(ContextoCompilador* ctx, const char* nome, TipoDado tipo, const char* funcao_escopo,
                        LimitadorTamanho limitador, int tem_limitador) {
+    int id_nome = internar_nome(ctx, nome, strlen(nome));
+
     /* Verifica se variável já existe (nomes devem ser únicos globalmente) */
-    if (buscar_variavel(nome) != NULL) {
-        printf("ALERTA: Variável '%s' já foi declarada anteriormente na linha %d.\n", nome, token_atual.linha);
+    if (buscar_variavel_id(ctx, id_nome) != NULL) {
+        fprintf(ctx->saida, "ALERTA: Variável '%s' já foi declarada anteriormente na linha %d, coluna %d.\n", nome, ctx->token_atual.linha, ctx->token_atual.coluna);
         return;
     }
 
-    EntradaTabela* nova = (EntradaTabela*) alocar_memoria(sizeof(EntradaTabela));
+    EntradaTabela* nova = (EntradaTabela*) pool_alocar(&ctx->pool_entradas);
 
-    size_t len_nome = strlen(nome) + 1;
-    nova->nome = (char*) alocar_memoria(len_nome);
-    strncpy(nova->nome, nome, len_nome);
+    /* Nome e escopo apontam para as cópias canônicas da tabela de nomes. */
+    nova->id_nome = id_nome;
+    nova->nome = nome_por_id(ctx, id_nome);
 
     nova->tipo = tipo;
     nova->valor = NULL;
 
-    size_t len_funcao = strlen(funcao_escopo) + 1;
-    nova->funcao_escopo = (char*) alocar_memoria(len_funcao);
-    strncpy(nova->funcao_escopo, funcao_escopo, len_funcao);
+    nova->funcao_escopo = nome_por_id(ctx, internar_nome(ctx, funcao_escopo, strlen(funcao_escopo)));
 
     nova->limitador = limitador;
     nova->tem_limitador = tem_limitador;
-    nova->proxima = tabela_simbolos->primeira;
+    nova->ordem = ctx->tabela_simbolos->total_entradas;
+    nova->proxima = ctx->tabela_simbolos->primeira;
+
+    ctx->tabela_simbolos->primeira = nova;
+    ctx->tabela_simbolos->total_entradas++;
 
-    tabela_simbolos->primeira = nova;
-    tabela_simbolos->total_entradas++;
+    /* Mantém a carga do índice abaixo de 50%. */
+    if (ctx->tabela_simbolos->total_entradas * 2 > ctx->tabela_simbolos->capacidade_indice) {
+        expandir_indice(ctx);
+    } else {
+        inserir_no_indice(ctx->tabela_simbolos->indice, ctx->tabela_simbolos->capacidade_indice, nova);
+    }
 }
 
-EntradaTabela* buscar_variavel(const char* nome) {
-    EntradaTabela* atual = tabela_simbolos->primeira;
-    while (atual != NULL) {
-        if (strcmp(atual->nome, nome) == 0) {
-            return atual;
+EntradaTabela* buscar_variavel_id(ContextoCompilador* ctx, int id_nome) {
+    int mascara = ctx->tabela_simbolos->capacidade_indice - 1;
+    int slot = slot_inicial_indice(id_nome, ctx->tabela_simbolos->capacidade_indice);
+    while (ctx->tabela_simbolos->indice[slot] != NULL) {
+        if (ctx->tabela_simbolos->indice[slot]->id_nome == id_nome) {
+            return ctx->tabela_simbolos->indice[slot];
         }
-        atual = atual->proxima;
+        slot = (slot + 1) & mascara;
     }
     return NULL;
 }
 
-void exibir_tabela_simbolos() {
-    printf("\n------------- TABELA DE SÍMBOLOS -------------\n");
-    printf("%-15s | %-10s | %-15s | %-10s | %s\n", "NOME", "TIPO", "FUNÇÃO/ESCOPO", "LIMITADOR", "VALOR");
-    printf("----------------------------------------------------------------------\n");
+EntradaTabela* buscar_variavel(ContextoCompilador* ctx, const char* nome) {
+    /* Um nome nunca internado não pode estar na tabela. */
+    int id = buscar_id_nome(ctx, nome, strlen(nome));
+    if (id < 0) {
+        return NULL;
+    }
+    return buscar_variavel_id(ctx, id);
+}
+
+void exibir_tabela_simbolos(ContextoCompilador* ctx) {
+    fprintf(ctx->saida, "\n------------- TABELA DE SÍMBOLOS -------------\n");
+    fprintf(ctx->saida, "%-15s | %-10s | %-15s | %-10s | %s\n", "NOME", "TIPO", "FUNÇÃO/ESCOPO", "LIMITADOR", "VALOR");
+    fprintf(ctx->saida, "----------------------------------------------------------------------\n");
 
-    EntradaTabela* atual = tabela_simbolos->primeira;
+    EntradaTabela* atual = ctx->tabela_simbolos->primeira;
     while (atual != NULL) {
         const char* tipo_str;
         char limitador_str[32] = "N/A";
@@ -87,733 +174,1161 @@ void exibir_tabela_simbolos() {
             }
         }
 
-        printf("%-15s | %-10s | %-15s | %-10s | %s\n",
+        fprintf(ctx->saida, "%-15s | %-10s | %-15s | %-10s | %s\n",
                atual->nome, tipo_str, atual->funcao_escopo, limitador_str,
                atual->valor ? atual->valor : "N/A");
         atual = atual->proxima;
     }
-    printf("----------------------------------------------------------------------\n");
-    printf("Total de variáveis: %d\n", tabela_simbolos->total_entradas);
+    fprintf(ctx->saida, "----------------------------------------------------------------------\n");
+    fprintf(ctx->saida, "Total de variáveis: %d\n", ctx->tabela_simbolos->total_entradas);
 }
 
-void destruir_tabela_simbolos() {
-    EntradaTabela* atual = tabela_simbolos->primeira;
-    while (atual != NULL) {
-        EntradaTabela* proxima = atual->proxima;
+void destruir_tabela_simbolos(ContextoCompilador* ctx) {
+    /* Entradas, índice e a pilha de operações vivem na região sintática: uma única liberação. */
+    pool_reiniciar(&ctx->pool_entradas);
+    liberar_regiao(ctx, REGIAO_SINTATICO);
+    ctx->tabela_simbolos = NULL;
+    memset(&ctx->operacoes_direita, 0, sizeof(PilhaOperacoes));
+}
 
-        liberar_memoria(atual->nome, strlen(atual->nome) + 1);
-        liberar_memoria(atual->funcao_escopo, strlen(atual->funcao_escopo) + 1);
-        if (atual->valor) {
-            liberar_memoria(atual->valor, strlen(atual->valor) + 1);
-        }
-        liberar_memoria(atual, sizeof(EntradaTabela));
+/* --- PILHA DE BALANCEAMENTO --- */
+
+#define CAPACIDADE_INICIAL_PILHA 16
+#define BLOCO_BALANCEAMENTO 64   /* Tokens por bloco da contagem vetorizada (cabe em um unsigned char). */
 
-        atual = proxima;
+void inicializar_pilha_balanceamento(ContextoCompilador* ctx) {
+    const char* modo = getenv("COMPILADOR_BALANCEAMENTO");
+    ctx->pilha_balanceamento = (PilhaBalanceamento*) alocar_memoria(ctx, sizeof(PilhaBalanceamento), CATEGORIA_PILHA);
+    ctx->pilha_balanceamento->itens = NULL; /* Nulo até a alocação: a pilha pode ser destruída se a memória acabar. */
+    ctx->pilha_balanceamento->capacidade = 0;
+    ctx->pilha_balanceamento->topo = -1;
+    ctx->pilha_balanceamento->modo = (modo != NULL && strcmp(modo, "previo") == 0) ? BALANCEAMENTO_PREVIO : BALANCEAMENTO_PILHA;
+
+    if (ctx->pilha_balanceamento->modo == BALANCEAMENTO_PILHA) {
+        ctx->pilha_balanceamento->itens = (ItemBalanceamento*) alocar_memoria(ctx, sizeof(ItemBalanceamento) * CAPACIDADE_INICIAL_PILHA, CATEGORIA_PILHA);
+        ctx->pilha_balanceamento->capacidade = CAPACIDADE_INICIAL_PILHA;
     }
-    liberar_memoria(tabela_simbolos, sizeof(TabelaSimbolos));
 }
 
-/* --- PILHA DE BALANCEAMENTO --- */
-PilhaBalanceamento* pilha_balanceamento = NULL;
-
-void inicializar_pilha_balanceamento() {
-    pilha_balanceamento = (PilhaBalanceamento*) alocar_memoria(sizeof(PilhaBalanceamento));
-    pilha_balanceamento->capacidade = 100;
-    pilha_balanceamento->itens = (ItemBalanceamento*) alocar_memoria(sizeof(ItemBalanceamento) * 100);
-    pilha_balanceamento->topo = -1;
+static void expandir_pilha_balanceamento(ContextoCompilador* ctx) {
+    /* Cresce geometricamente: o aninhamento de código gerado não tem limite fixo. */
+    PilhaBalanceamento* pilha = ctx->pilha_balanceamento;
+    int nova_capacidade = pilha->capacidade * 2;
+    ItemBalanceamento* novos = (ItemBalanceamento*) alocar_memoria(ctx, sizeof(ItemBalanceamento) * nova_capacidade, CATEGORIA_PILHA);
+    memcpy(novos, pilha->itens, sizeof(ItemBalanceamento) * (pilha->topo + 1));
+    liberar_memoria(ctx, pilha->itens, sizeof(ItemBalanceamento) * pilha->capacidade, CATEGORIA_PILHA);
+    pilha->itens = novos;
+    pilha->capacidade = nova_capacidade;
 }
 
-void empilhar_delimitador(char delimitador, int linha) {
-    if (pilha_balanceamento->topo >= pilha_balanceamento->capacidade - 1) {
-        fprintf(stderr, "ERRO: Pilha de balanceamento cheia na linha %d.\n", linha);
-        erro_sintatico_encontrado = 1;
-        return;
+void empilhar_delimitador(ContextoCompilador* ctx, char delimitador, int linha, int coluna) {
+    PilhaBalanceamento* pilha = ctx->pilha_balanceamento;
+    if (pilha->modo == BALANCEAMENTO_PREVIO) return;
+
+    if (pilha->topo == pilha->capacidade - 1) {
+        expandir_pilha_balanceamento(ctx);
     }
 
-    pilha_balanceamento->topo++;
-    pilha_balanceamento->itens[pilha_balanceamento->topo].delimitador = delimitador;
-    pilha_balanceamento->itens[pilha_balanceamento->topo].linha = linha;
+    pilha->topo++;
+    pilha->itens[pilha->topo].delimitador = delimitador;
+    pilha->itens[pilha->topo].linha = linha;
+    pilha->itens[pilha->topo].coluna = coluna;
 }
 
-int desempilhar_delimitador(char delimitador_fechamento, int linha) {
-    if (pilha_balanceamento->topo < 0) {
-        fprintf(stderr, "ERRO SINTÁTICO: Delimitador '%c' sem abertura correspondente na linha %d.\n",
-                delimitador_fechamento, linha);
-        erro_sintatico_encontrado = 1;
-        return 0;
+/* Abertura que corresponde a um delimitador de fechamento; ' ' se não houver. */
+static char abertura_correspondente(char delimitador_fechamento) {
+    switch (delimitador_fechamento) {
+        case ')': return '(';
+        case '}': return '{';
+        case ']': return '[';
+        case '"': return '"';
+        default: return ' ';
     }
+}
 
-    char delimitador_abertura = pilha_balanceamento->itens[pilha_balanceamento->topo].delimitador;
-    int linha_abertura = pilha_balanceamento->itens[pilha_balanceamento->topo].linha;
+int desempilhar_delimitador(ContextoCompilador* ctx, char delimitador_fechamento, int linha, int coluna) {
+    if (ctx->pilha_balanceamento->modo == BALANCEAMENTO_PREVIO) return 1;
 
-    char esperado = ' ';
-    switch (delimitador_fechamento) {
-        case ')': esperado = '('; break;
-        case '}': esperado = '{'; break;
-        case ']': esperado = '['; break;
-        case '"': esperado = '"'; break;
-        default: ;
+    if (ctx->pilha_balanceamento->topo < 0) {
+        relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Delimitador '%c' sem abertura correspondente na linha %d, coluna %d.\n",
+                delimitador_fechamento, linha, coluna);
+        return 0;
     }
 
-    if (delimitador_abertura != esperado) {
-        fprintf(stderr, "ERRO SINTÁTICO: Delimitador '%c' na linha %d não corresponde ao '%c' aberto na linha %d.\n",
-                delimitador_fechamento, linha, delimitador_abertura, linha_abertura);
-        erro_sintatico_encontrado = 1;
+    char delimitador_abertura = ctx->pilha_balanceamento->itens[ctx->pilha_balanceamento->topo].delimitador;
+    int linha_abertura = ctx->pilha_balanceamento->itens[ctx->pilha_balanceamento->topo].linha;
+    int coluna_abertura = ctx->pilha_balanceamento->itens[ctx->pilha_balanceamento->topo].coluna;
+
+    if (delimitador_abertura != abertura_correspondente(delimitador_fechamento)) {
+        relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Delimitador '%c' na linha %d, coluna %d não corresponde ao '%c' aberto na linha %d, coluna %d.\n",
+                delimitador_fechamento, linha, coluna, delimitador_abertura, linha_abertura, coluna_abertura);
         return 0;
     }
 
-    pilha_balanceamento->topo--;
+    ctx->pilha_balanceamento->topo--;
     return 1;
 }
 
-void destruir_pilha_balanceamento() {
-    if (pilha_balanceamento) {
-        liberar_memoria(pilha_balanceamento->itens, sizeof(ItemBalanceamento) * pilha_balanceamento->capacidade);
-        liberar_memoria(pilha_balanceamento, sizeof(PilhaBalanceamento));
+/* Espécie (1: (), 2: {}, 3: []) de cada token de abertura e de fechamento; 0 nos demais. */
+static const unsigned char abertura_do_tipo[TOKEN_ERRO + 1] = {
+    [TOKEN_PARENTESES_ESQ] = 1, [TOKEN_CHAVES_ESQ] = 2, [TOKEN_COLCHETES_ESQ] = 3
+};
+static const unsigned char fechamento_do_tipo[TOKEN_ERRO + 1] = {
+    [TOKEN_PARENTESES_DIR] = 1, [TOKEN_CHAVES_DIR] = 2, [TOKEN_COLCHETES_DIR] = 3
+};
+
+#define FUNDO_PILHA_PREVIA 0xFF  /* Sentinela: não corresponde a nenhum fechamento. */
+
+/*
+ * Refaz a varredura guardando os índices das aberturas, só para descrever o
+ * primeiro desequilíbrio com linha e coluna.
+ */
+static void relatar_desequilibrio(ContextoCompilador* ctx, int aberturas) {
+    const unsigned char* tipos = ctx->fluxo_tokens->tipos;
+    int* abertos = (int*) alocar_memoria(ctx, sizeof(int) * (aberturas + 1), CATEGORIA_PILHA);
+    int topo = -1;
+    int relatado = 0;
+
+    for (int i = 0; i < ctx->fluxo_tokens->total && !relatado; i++) {
+        if (abertura_do_tipo[tipos[i]]) {
+            abertos[++topo] = i;
+        } else if (fechamento_do_tipo[tipos[i]]) {
+            Token fechamento = token_na_posicao(ctx, i);
+            if (topo < 0) {
+                relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Delimitador '%c' sem abertura correspondente na linha %d, coluna %d.\n",
+                        fechamento.lexema[0], fechamento.linha, fechamento.coluna);
+                relatado = 1;
+            } else if (abertura_do_tipo[tipos[abertos[topo]]] != fechamento_do_tipo[tipos[i]]) {
+                Token abertura = token_na_posicao(ctx, abertos[topo]);
+                relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Delimitador '%c' na linha %d, coluna %d não corresponde ao '%c' aberto na linha %d, coluna %d.\n",
+                        fechamento.lexema[0], fechamento.linha, fechamento.coluna, abertura.lexema[0], abertura.linha, abertura.coluna);
+                relatado = 1;
+            } else {
+                topo--;
+            }
+        }
     }
+
+    if (!relatado && topo >= 0) {
+        Token abertura = token_na_posicao(ctx, abertos[topo]);
+        relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Delimitador '%c' aberto na linha %d, coluna %d não foi fechado.\n",
+                abertura.lexema[0], abertura.linha, abertura.coluna);
+    }
+
+    liberar_memoria(ctx, abertos, sizeof(int) * (aberturas + 1), CATEGORIA_PILHA);
+}
+
+int verificar_balanceamento_previo(ContextoCompilador* ctx) {
+    const unsigned char* tipos = ctx->fluxo_tokens->tipos;
+    int total = ctx->fluxo_tokens->total;
+
+    /*
+     * 1ª passada: conta as aberturas. Um byte por token e nenhum desvio no
+     * corpo do laço; em blocos de tamanho fixo o compilador o vetoriza mesmo
+     * em -O2. O total dimensiona a pilha de uma vez.
+     */
+    int aberturas = 0;
+    int i = 0;
+    for (; i + BLOCO_BALANCEAMENTO <= total; i += BLOCO_BALANCEAMENTO) {
+        unsigned char no_bloco = 0;
+        for (int j = 0; j < BLOCO_BALANCEAMENTO; j++) {
+            unsigned char tipo = tipos[i + j];
+            no_bloco += (tipo == TOKEN_PARENTESES_ESQ) | (tipo == TOKEN_CHAVES_ESQ) | (tipo == TOKEN_COLCHETES_ESQ);
+        }
+        aberturas += no_bloco;
+    }
+    for (; i < total; i++) {
+        unsigned char tipo = tipos[i];
+        aberturas += (tipo == TOKEN_PARENTESES_ESQ) | (tipo == TOKEN_CHAVES_ESQ) | (tipo == TOKEN_COLCHETES_ESQ);
+    }
+
+    /*
+     * 2ª passada: pilha de espécies sem desvios. Toda iteração grava no topo
+     * seguinte e ajusta o topo aritmeticamente, de modo que a alternância
+     * imprevisível entre aberturas e fechamentos não custa erros de predição.
+     * O fundo é uma sentinela, e o topo nunca desce abaixo dela.
+     */
+    unsigned char* pilha = (unsigned char*) alocar_memoria(ctx, aberturas + 2, CATEGORIA_PILHA);
+    int topo = 0;
+    int falhou = 0;
+    pilha[0] = FUNDO_PILHA_PREVIA;
+
+    for (i = 0; i < total; i++) {
+        unsigned char abre = abertura_do_tipo[tipos[i]];
+        unsigned char fecha = fechamento_do_tipo[tipos[i]];
+        pilha[topo + 1] = abre;
+        falhou |= (fecha != 0) & (pilha[topo] != fecha);
+        topo += (abre != 0) - ((fecha != 0) & (topo > 0));
+    }
+    falhou |= topo != 0;
+
+    liberar_memoria(ctx, pilha, aberturas + 2, CATEGORIA_PILHA);
+
+    if (falhou) {
+        relatar_desequilibrio(ctx, aberturas);
+        /* O erro não pertence ao token atual: não deve silenciar o primeiro erro do parser. */
+        ctx->posicao_ultimo_erro = -1;
+    }
+    return !falhou;
+}
+
+void destruir_pilha_balanceamento(ContextoCompilador* ctx) {
+    if (ctx->pilha_balanceamento) {
+        liberar_memoria(ctx, ctx->pilha_balanceamento->itens, sizeof(ItemBalanceamento) * ctx->pilha_balanceamento->capacidade, CATEGORIA_PILHA);
+        liberar_memoria(ctx, ctx->pilha_balanceamento, sizeof(PilhaBalanceamento), CATEGORIA_PILHA);
+        ctx->pilha_balanceamento = NULL;
+    }
+}
+
+/* --- ÁRVORE SINTÁTICA --- */
+
+#define CAPACIDADE_INICIAL_BLOCOS_ARVORE 16
+
+void inicializar_arvore_sintatica(ContextoCompilador* ctx) {
+    /* Os blocos de nós só são reservados quando o parser precisa deles. */
+    ArvoreSintatica* arvore = (ArvoreSintatica*) alocar_na_regiao(ctx, REGIAO_ARVORE, sizeof(ArvoreSintatica));
+    arvore->blocos = NULL;
+    arvore->total_blocos = 0;
+    arvore->capacidade_blocos = 0;
+    arvore->total = 0;
+    arvore->raiz = NO_NULO;
+    ctx->arvore = arvore;
+}
+
+void destruir_arvore_sintatica(ContextoCompilador* ctx) {
+    /* Os vetores e o cabeçalho vivem na região da árvore: uma única liberação. */
+    liberar_regiao(ctx, REGIAO_ARVORE);
+    ctx->arvore = NULL;
+}
+
+/* Reserva mais um bloco de nós; os blocos já reservados não se movem. */
+static void reservar_bloco_arvore(ContextoCompilador* ctx) {
+    ArvoreSintatica* arvore = ctx->arvore;
+    if (arvore->total_blocos == arvore->capacidade_blocos) {
+        /* O diretório antigo fica na região até o fim da fase; dobrando, os descartados somam menos que o atual. */
+        int capacidade = arvore->capacidade_blocos == 0 ? CAPACIDADE_INICIAL_BLOCOS_ARVORE : arvore->capacidade_blocos * 2;
+        BlocoArvore** blocos = (BlocoArvore**) alocar_na_regiao(ctx, REGIAO_ARVORE, sizeof(BlocoArvore*) * capacidade);
+        if (arvore->total_blocos > 0) {
+            memcpy(blocos, arvore->blocos, sizeof(BlocoArvore*) * arvore->total_blocos);
+        }
+        arvore->blocos = blocos;
+        arvore->capacidade_blocos = capacidade;
+    }
+    arvore->blocos[arvore->total_blocos] = (BlocoArvore*) alocar_na_regiao(ctx, REGIAO_ARVORE, sizeof(BlocoArvore));
+    arvore->total_blocos++;
+}
+
+static int criar_no(ContextoCompilador* ctx, TipoNo tipo, int token) {
+    ArvoreSintatica* arvore = ctx->arvore;
+    if (arvore->total == arvore->total_blocos * NOS_POR_BLOCO_ARVORE) {
+        reservar_bloco_arvore(ctx);
+    }
+    int no = arvore->total++;
+    CAMPO_NO(arvore, tipos, no) = (unsigned char) tipo;
+    CAMPO_NO(arvore, tokens, no) = token;
+    CAMPO_NO(arvore, primeiros_filhos, no) = NO_NULO;
+    CAMPO_NO(arvore, proximos_irmaos, no) = NO_NULO;
+    return no;
+}
+
+/* Liga 'filho' ao fim da lista de filhos de 'pai'; 'ultimo' guarda o filho mais recente. */
+static void anexar_filho(ContextoCompilador* ctx, int pai, int* ultimo, int filho) {
+    if (*ultimo == NO_NULO) {
+        CAMPO_NO(ctx->arvore, primeiros_filhos, pai) = filho;
+    } else {
+        CAMPO_NO(ctx->arvore, proximos_irmaos, *ultimo) = filho;
+    }
+    *ultimo = filho;
+}
+
+static int criar_no_binario(ContextoCompilador* ctx, int operador, int esquerdo, int direito) {
+    int no = criar_no(ctx, NO_BINARIO, operador);
+    CAMPO_NO(ctx->arvore, primeiros_filhos, no) = esquerdo;
+    CAMPO_NO(ctx->arvore, proximos_irmaos, esquerdo) = direito;
+    return no;
+}
+
+/* --- PRECEDÊNCIA DE OPERADORES --- */
+
+typedef enum {
+    PRECEDENCIA_NENHUMA,        /* O token não é operador binário: encerra a expressão. */
+    PRECEDENCIA_OU,
+    PRECEDENCIA_E,
+    PRECEDENCIA_RELACIONAL,
+    PRECEDENCIA_ADITIVA,
+    PRECEDENCIA_MULTIPLICATIVA,
+    PRECEDENCIA_EXPONENCIAL,
+    PRECEDENCIA_OPERANDO        /* Fator isolado ou entre parênteses. */
+} Precedencia;
+
+typedef enum {
+    ASSOCIATIVO_ESQUERDA,
+    ASSOCIATIVO_DIREITA,
+    NAO_ASSOCIATIVO             /* 'a < b < c' não forma uma única expressão. */
+} Associatividade;
+
+typedef struct {
+    Precedencia precedencia;
+    Associatividade associatividade;
+} OperadorBinario;
+
+/*
+ * Indexada pelo tipo do token. Um operador novo é só mais uma linha aqui:
+ * o laço de analisar_operacao não depende de quantos níveis existem.
+ */
+static const OperadorBinario operadores_binarios[TOKEN_ERRO + 1] = {
+    [TOKEN_OP_OU]             = {PRECEDENCIA_OU,             ASSOCIATIVO_ESQUERDA},
+    [TOKEN_OP_E]              = {PRECEDENCIA_E,              ASSOCIATIVO_ESQUERDA},
+    [TOKEN_OP_IGUAL]          = {PRECEDENCIA_RELACIONAL,     NAO_ASSOCIATIVO},
+    [TOKEN_OP_DIFERENTE]      = {PRECEDENCIA_RELACIONAL,     NAO_ASSOCIATIVO},
+    [TOKEN_OP_MENOR]          = {PRECEDENCIA_RELACIONAL,     NAO_ASSOCIATIVO},
+    [TOKEN_OP_MENOR_IGUAL]    = {PRECEDENCIA_RELACIONAL,     NAO_ASSOCIATIVO},
+    [TOKEN_OP_MAIOR]          = {PRECEDENCIA_RELACIONAL,     NAO_ASSOCIATIVO},
+    [TOKEN_OP_MAIOR_IGUAL]    = {PRECEDENCIA_RELACIONAL,     NAO_ASSOCIATIVO},
+    [TOKEN_OP_SOMA]           = {PRECEDENCIA_ADITIVA,        ASSOCIATIVO_ESQUERDA},
+    [TOKEN_OP_SUBTRACAO]      = {PRECEDENCIA_ADITIVA,        ASSOCIATIVO_ESQUERDA},
+    [TOKEN_OP_MULTIPLICACAO]  = {PRECEDENCIA_MULTIPLICATIVA, ASSOCIATIVO_ESQUERDA},
+    [TOKEN_OP_DIVISAO]        = {PRECEDENCIA_MULTIPLICATIVA, ASSOCIATIVO_ESQUERDA},
+    [TOKEN_OP_EXPONENCIACAO]  = {PRECEDENCIA_EXPONENCIAL,    ASSOCIATIVO_DIREITA},
+};
+
+#define CAPACIDADE_INICIAL_OPERACOES 32
+
+static void empilhar_operacao(ContextoCompilador* ctx, int operador, int esquerdo) {
+    PilhaOperacoes* pilha = &ctx->operacoes_direita;
+    if (pilha->total + 2 > pilha->capacidade) {
+        /* A pilha antiga fica na região até o fim da fase; dobrando, as descartadas somam menos que a atual. */
+        int capacidade = pilha->capacidade == 0 ? CAPACIDADE_INICIAL_OPERACOES : pilha->capacidade * 2;
+        int* itens = (int*) alocar_na_regiao(ctx, REGIAO_SINTATICO, sizeof(int) * capacidade);
+        if (pilha->total > 0) {
+            memcpy(itens, pilha->itens, sizeof(int) * pilha->total);
+        }
+        pilha->itens = itens;
+        pilha->capacidade = capacidade;
+    }
+    pilha->itens[pilha->total++] = operador;
+    pilha->itens[pilha->total++] = esquerdo;
+}
+
+/* Uma comparação é um nó binário relacional ou lógico. */
+static int eh_comparacao(ContextoCompilador* ctx, int no) {
+    if (CAMPO_NO(ctx->arvore, tipos, no) != NO_BINARIO) return 0;
+    TipoToken operador = (TipoToken) ctx->fluxo_tokens->tipos[CAMPO_NO(ctx->arvore, tokens, no)];
+    return operadores_binarios[operador].precedencia <= PRECEDENCIA_RELACIONAL;
 }
 
 /* --- FUNÇÕES DO PARSER --- */
 
-void inicializar_parser() {
-    inicializar_tabela_simbolos();
-    inicializar_pilha_balanceamento();
-    inicializar_analisador_semantico();
-    erro_sintatico_encontrado = 0;
-    modulo_principal_encontrado = 0;
-    token_atual = obter_proximo_token();
+void inicializar_parser(ContextoCompilador* ctx) {
+    inicializar_tabela_simbolos(ctx);
+    inicializar_arvore_sintatica(ctx);
+    inicializar_pilha_balanceamento(ctx);
+    inicializar_analisador_semantico(ctx);
+    ctx->erro_sintatico_encontrado = 0;
+    ctx->erros_sintaticos = 0;
+    ctx->posicao_ultimo_erro = -1;
+    ctx->profundidade_aninhamento = 0;
+    ctx->modulo_principal_encontrado = 0;
+    ctx->posicao_token = 0;
+    ctx->janela.fim = 0;
+    memset(&ctx->operacoes_direita, 0, sizeof(PilhaOperacoes));
+    ctx->token_atual = *espiar_token(ctx, 0);
+    ctx->token_anterior = ctx->token_atual;
 }
 
-void consumir_token() {
-    if (token_atual.tipo != TOKEN_FIM_DE_ARQUIVO && token_atual.tipo != TOKEN_ERRO) {
-        destruir_token(token_atual);
-        token_atual = obter_proximo_token();
+const Token* espiar_token(ContextoCompilador* ctx, int distancia) {
+    /* Mais longe que o anel, a montagem sobrescreveria tokens ainda não consumidos. */
+    assert(distancia >= 0 && distancia < TAMANHO_JANELA_TOKENS);
+    JanelaTokens* janela = &ctx->janela;
+    int posicao = ctx->posicao_token + distancia;
+    if (posicao >= ctx->fluxo_tokens->total) {
+        posicao = ctx->fluxo_tokens->total - 1; /* O último token é sempre o fim de arquivo. */
+    }
+
+    /* Monta só o que ainda não está no anel; posições já consumidas são sobrescritas. */
+    while (janela->fim <= posicao) {
+        janela->itens[janela->fim & (TAMANHO_JANELA_TOKENS - 1)] = token_na_posicao(ctx, janela->fim);
+        janela->fim++;
     }
+    return &janela->itens[posicao & (TAMANHO_JANELA_TOKENS - 1)];
 }
 
-int esperar_token(TipoToken tipo_esperado) {
-    if (token_atual.tipo == tipo_esperado) {
-        consumir_token();
+void consumir_token(ContextoCompilador* ctx) {
+    /* Os tokens pertencem a fluxo_tokens; o parser apenas avança o índice. */
+    if (ctx->token_atual.tipo != TOKEN_FIM_DE_ARQUIVO && ctx->token_atual.tipo != TOKEN_ERRO) {
+        ctx->token_anterior = ctx->token_atual;
+        ctx->posicao_token++;
+        ctx->token_atual = *espiar_token(ctx, 0);
+    }
+}
+
+int esperar_token(ContextoCompilador* ctx, TipoToken tipo_esperado) {
+    if (ctx->token_atual.tipo == tipo_esperado) {
+        consumir_token(ctx);
         return 1;
     } else {
-        fprintf(stderr, "ERRO SINTÁTICO: Esperado %s, encontrado %s ('%s') na linha %d.\n",
-                tipo_token_para_str(tipo_esperado), tipo_token_para_str(token_atual.tipo),
-                token_atual.lexema, token_atual.linha);
-        erro_sintatico_encontrado = 1;
+        relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado %s, encontrado %s ('%s') na linha %d, coluna %d.\n",
+                tipo_token_para_str(tipo_esperado), tipo_token_para_str(ctx->token_atual.tipo),
+                ctx->token_atual.lexema, ctx->token_atual.linha, ctx->token_atual.coluna);
         return 0;
     }
 }
 
-int verificar_ausencia_token(TipoToken token_nao_esperado, const char* contexto) {
-    if (token_atual.tipo == token_nao_esperado) {
-        fprintf(stderr, "ERRO SINTÁTICO: Token '%s' não deveria estar presente após %s na linha %d.\n",
-                token_atual.lexema, contexto, token_atual.linha);
-        erro_sintatico_encontrado = 1;
+int verificar_ausencia_token(ContextoCompilador* ctx, TipoToken token_nao_esperado, const char* contexto) {
+    if (ctx->token_atual.tipo == token_nao_esperado) {
+        relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Token '%s' não deveria estar presente após %s na linha %d, coluna %d.\n",
+                ctx->token_atual.lexema, contexto, ctx->token_atual.linha, ctx->token_atual.coluna);
         return 0;
     }
     return 1;
 }
 
-int analisar_programa() {
+/*
+ * Recuperação em modo pânico: descarta tokens até uma fronteira de comando.
+ * Para depois de um ';' ou de um bloco '{...}' inteiro, e antes de um '}'
+ * sem par, de 'funcao', de 'principal' ou do fim do arquivo.
+ */
+static void sincronizar(ContextoCompilador* ctx) {
+    int profundidade = 0;
+
+    while (1) {
+        switch (ctx->token_atual.tipo) {
+            case TOKEN_FIM_DE_ARQUIVO: case TOKEN_ERRO:
+            case TOKEN_FUNCAO: case TOKEN_PRINCIPAL:
+                return;
+            case TOKEN_PONTO_VIRGULA:
+                if (profundidade == 0) {
+                    consumir_token(ctx);
+                    return;
+                }
+                break;
+            case TOKEN_CHAVES_ESQ:
+                profundidade++;
+                break;
+            case TOKEN_CHAVES_DIR:
+                if (profundidade == 0) return;
+                if (--profundidade == 0) {
+                    consumir_token(ctx);
+                    return;
+                }
+                break;
+            default:
+                break;
+        }
+        consumir_token(ctx);
+    }
+}
+
+/* Descarta o restante da construção que falhou e os delimitadores que ela deixou abertos. */
+static void recuperar_de_erro(ContextoCompilador* ctx, int topo_pilha) {
+    sincronizar(ctx);
+    ctx->pilha_balanceamento->topo = topo_pilha;
+}
+
+static int analisar_corpo_programa(ContextoCompilador* ctx) {
     /* Programa = (Funcao | Declaracao)* */
-    while (token_atual.tipo != TOKEN_FIM_DE_ARQUIVO && !erro_sintatico_encontrado) {
-        if (token_atual.tipo == TOKEN_PRINCIPAL || token_atual.tipo == TOKEN_FUNCAO) {
-            if (!analisar_funcao()) {
-                return 0;
-            }
-        } else if (token_atual.tipo == TOKEN_INTEIRO || token_atual.tipo == TOKEN_TEXTO || token_atual.tipo == TOKEN_DECIMAL) {
-            if (!analisar_declaracao_variavel("global")) {
-                return 0;
-            }
+    int raiz = criar_no(ctx, NO_PROGRAMA, ctx->fluxo_tokens->total - 1);
+    int ultimo = NO_NULO;
+    ctx->arvore->raiz = raiz;
+
+    if (ctx->pilha_balanceamento->modo == BALANCEAMENTO_PREVIO) {
+        verificar_balanceamento_previo(ctx);
+    }
+
+    while (ctx->token_atual.tipo != TOKEN_FIM_DE_ARQUIVO && ctx->token_atual.tipo != TOKEN_ERRO && !analise_interrompida(ctx)) {
+        int filho;
+        int topo_pilha = ctx->pilha_balanceamento->topo;
+        int sucesso;
+
+        if (ctx->token_atual.tipo == TOKEN_PRINCIPAL || ctx->token_atual.tipo == TOKEN_FUNCAO) {
+            sucesso = analisar_funcao(ctx, &filho);
+        } else if (ctx->token_atual.tipo == TOKEN_INTEIRO || ctx->token_atual.tipo == TOKEN_TEXTO || ctx->token_atual.tipo == TOKEN_DECIMAL) {
+            sucesso = analisar_declaracao_variavel(ctx, "global", &filho);
         } else {
-            fprintf(stderr, "ERRO SINTÁTICO: Token inesperado '%s' na linha %d. Esperado função ou declaração de variável.\n",
-                    token_atual.lexema, token_atual.linha);
-            erro_sintatico_encontrado = 1;
-            return 0;
+            relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Token inesperado '%s' na linha %d, coluna %d. Esperado função ou declaração de variável.\n",
+                    ctx->token_atual.lexema, ctx->token_atual.linha, ctx->token_atual.coluna);
+            sucesso = 0;
+        }
+
+        if (sucesso) {
+            anexar_filho(ctx, raiz, &ultimo, filho);
+        } else {
+            /* Segue para a próxima função ou declaração; um '}' sem par é descartado. */
+            recuperar_de_erro(ctx, topo_pilha);
+            if (ctx->token_atual.tipo == TOKEN_CHAVES_DIR) consumir_token(ctx);
         }
     }
 
-    if (!modulo_principal_encontrado) {
-        fprintf(stderr, "ERRO SINTÁTICO: Módulo Principal Inexistente.\n");
-        erro_sintatico_encontrado = 1;
+    /* As verificações finais não decorrem do último erro: não são tratadas como cascata. */
+    ctx->posicao_ultimo_erro = -1;
+
+    if (!ctx->modulo_principal_encontrado) {
+        relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Módulo Principal Inexistente.\n");
         return 0;
     }
 
     /* Verifica se há delimitadores não fechados */
-    if (pilha_balanceamento->topo >= 0) {
-        char delim = pilha_balanceamento->itens[pilha_balanceamento->topo].delimitador;
-        int linha = pilha_balanceamento->itens[pilha_balanceamento->topo].linha;
-        fprintf(stderr, "ERRO SINTÁTICO: Delimitador '%c' aberto na linha %d não foi fechado.\n", delim, linha);
-        erro_sintatico_encontrado = 1;
+    if (ctx->pilha_balanceamento->topo >= 0) {
+        char delim = ctx->pilha_balanceamento->itens[ctx->pilha_balanceamento->topo].delimitador;
+        int linha = ctx->pilha_balanceamento->itens[ctx->pilha_balanceamento->topo].linha;
+        int coluna = ctx->pilha_balanceamento->itens[ctx->pilha_balanceamento->topo].coluna;
+        relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Delimitador '%c' aberto na linha %d, coluna %d não foi fechado.\n", delim, linha, coluna);
         return 0;
     }
 
-    return !erro_sintatico_encontrado;
+    return !ctx->erro_sintatico_encontrado;
+}
+
+int analisar_programa(ContextoCompilador* ctx) {
+    int resultado = analisar_corpo_programa(ctx);
+    /* Alertas ainda adiados saem antes dos relatórios. */
+    concluir_verificacoes_semanticas(ctx);
+    return resultado;
 }
 
-int analisar_funcao() {
-    char nome_funcao[256];
-    int linha_funcao = linha_atual;
+int analisar_funcao(ContextoCompilador* ctx, int* no) {
+    const char* nome_funcao = NULL;
+    int linha_funcao = ctx->token_atual.linha;
+    int coluna_funcao = ctx->token_atual.coluna;
+    int ultimo = NO_NULO;
 
-    if (token_atual.tipo == TOKEN_PRINCIPAL) {
-        strcpy(nome_funcao, "principal");
-        modulo_principal_encontrado = 1;
-        adicionar_funcao_declarada("principal", linha_funcao);
-        consumir_token();
+    if (ctx->token_atual.tipo == TOKEN_PRINCIPAL) {
+        nome_funcao = "principal";
+        ctx->modulo_principal_encontrado = 1;
+        adicionar_funcao_declarada(ctx, "principal", linha_funcao, coluna_funcao);
+        *no = criar_no(ctx, NO_FUNCAO, ctx->posicao_token);
+        consumir_token(ctx);
 
         /* principal() não tem parâmetros */
-        if (!esperar_token(TOKEN_PARENTESES_ESQ)) return 0;
-        empilhar_delimitador('(', token_atual.linha - 1);
-        if (!esperar_token(TOKEN_PARENTESES_DIR)) return 0;
-        if (!desempilhar_delimitador(')', token_atual.linha - 1)) return 0;
+        if (!esperar_token(ctx, TOKEN_PARENTESES_ESQ)) return 0;
+        empilhar_delimitador(ctx, '(', ctx->token_anterior.linha, ctx->token_anterior.coluna);
+        if (!esperar_token(ctx, TOKEN_PARENTESES_DIR)) return 0;
+        if (!desempilhar_delimitador(ctx, ')', ctx->token_anterior.linha, ctx->token_anterior.coluna)) return 0;
 
-    } else if (token_atual.tipo == TOKEN_FUNCAO) {
-        consumir_token();
+    } else if (ctx->token_atual.tipo == TOKEN_FUNCAO) {
+        consumir_token(ctx);
 
-        if (token_atual.tipo != TOKEN_ID_FUNCAO) {
-            fprintf(stderr, "ERRO SINTÁTICO: Esperado nome de função após 'funcao' na linha %d.\n", token_atual.linha);
-            erro_sintatico_encontrado = 1;
+        if (ctx->token_atual.tipo != TOKEN_ID_FUNCAO) {
+            relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado nome de função após 'funcao' na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
             return 0;
         }
 
-        strcpy(nome_funcao, token_atual.lexema);
-        adicionar_funcao_declarada(nome_funcao, linha_funcao);
-        consumir_token();
+        nome_funcao = ctx->token_atual.lexema; /* Cópia canônica: válida após consumir o token. */
+        adicionar_funcao_declarada(ctx, nome_funcao, linha_funcao, coluna_funcao);
+        *no = criar_no(ctx, NO_FUNCAO, ctx->posicao_token);
+        consumir_token(ctx);
 
-        if (!esperar_token(TOKEN_PARENTESES_ESQ)) return 0;
-        empilhar_delimitador('(', token_atual.linha - 1);
+        if (!esperar_token(ctx, TOKEN_PARENTESES_ESQ)) return 0;
+        empilhar_delimitador(ctx, '(', ctx->token_anterior.linha, ctx->token_anterior.coluna);
 
         /* Parâmetros (se houver) */
-        if (token_atual.tipo != TOKEN_PARENTESES_DIR) {
+        if (ctx->token_atual.tipo != TOKEN_PARENTESES_DIR) {
             do {
                 TipoDado tipo_param;
-                if (token_atual.tipo == TOKEN_INTEIRO) tipo_param = TIPO_INTEIRO;
-                else if (token_atual.tipo == TOKEN_TEXTO) tipo_param = TIPO_TEXTO;
-                else if (token_atual.tipo == TOKEN_DECIMAL) tipo_param = TIPO_DECIMAL;
+                if (ctx->token_atual.tipo == TOKEN_INTEIRO) tipo_param = TIPO_INTEIRO;
+                else if (ctx->token_atual.tipo == TOKEN_TEXTO) tipo_param = TIPO_TEXTO;
+                else if (ctx->token_atual.tipo == TOKEN_DECIMAL) tipo_param = TIPO_DECIMAL;
                 else {
-                    fprintf(stderr, "ERRO SINTÁTICO: Esperado tipo de dado para o parâmetro na linha %d.\n", token_atual.linha);
-                    erro_sintatico_encontrado = 1;
+                    relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado tipo de dado para o parâmetro na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
                     return 0;
                 }
-                consumir_token(); // Consome o tipo (inteiro, texto, etc.)
+                consumir_token(ctx); // Consome o tipo (inteiro, texto, etc.)
 
-                if (token_atual.tipo != TOKEN_ID_VARIAVEL) {
-                    fprintf(stderr, "ERRO SINTÁTICO: Esperado nome de variável para o parâmetro na linha %d.\n", token_atual.linha);
-                    erro_sintatico_encontrado = 1;
+                if (ctx->token_atual.tipo != TOKEN_ID_VARIAVEL) {
+                    relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado nome de variável para o parâmetro na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
                     return 0;
                 }
 
                 // Adiciona o parâmetro à tabela de símbolos (sem limitador, conforme especificação)
-                adicionar_variavel(token_atual.lexema, tipo_param, nome_funcao, (LimitadorTamanho){0, 0}, 0);
-                consumir_token(); // Consome o nome da variável
+                adicionar_variavel(ctx, ctx->token_atual.lexema, tipo_param, nome_funcao, (LimitadorTamanho){0, 0}, 0);
+                anexar_filho(ctx, *no, &ultimo, criar_no(ctx, NO_PARAMETRO, ctx->posicao_token));
+                consumir_token(ctx); // Consome o nome da variável
 
                 // Se houver uma vírgula, espera o próximo parâmetro
-                if (token_atual.tipo == TOKEN_VIRGULA) {
-                    consumir_token();
+                if (ctx->token_atual.tipo == TOKEN_VIRGULA) {
+                    consumir_token(ctx);
                 } else {
                     break; // Sai do loop se não houver mais vírgulas
                 }
             } while (1);
         }
 
-        if (!esperar_token(TOKEN_PARENTESES_DIR)) return 0;
-        if (!desempilhar_delimitador(')', token_atual.linha - 1)) return 0;
+        if (!esperar_token(ctx, TOKEN_PARENTESES_DIR)) return 0;
+        if (!desempilhar_delimitador(ctx, ')', ctx->token_anterior.linha, ctx->token_anterior.coluna)) return 0;
     }
 
     /* Corpo da função */
-    if (!analisar_bloco(nome_funcao)) return 0;
+    int corpo;
+    if (!analisar_bloco(ctx, nome_funcao, &corpo)) return 0;
+    anexar_filho(ctx, *no, &ultimo, corpo);
 
     return 1;
 }
 
-int analisar_declaracao_variavel(const char* funcao_escopo) {
+int analisar_declaracao_variavel(ContextoCompilador* ctx, const char* funcao_escopo, int* no) {
     TipoDado tipo;
     LimitadorTamanho limitador = {0, 0};
     int tem_limitador = 0;
+    int ultimo = NO_NULO;
 
     /* Determina o tipo */
-    if (token_atual.tipo == TOKEN_INTEIRO) {
+    if (ctx->token_atual.tipo == TOKEN_INTEIRO) {
         tipo = TIPO_INTEIRO;
-    } else if (token_atual.tipo == TOKEN_TEXTO) {
+    } else if (ctx->token_atual.tipo == TOKEN_TEXTO) {
         tipo = TIPO_TEXTO;
-    } else if (token_atual.tipo == TOKEN_DECIMAL) {
+    } else if (ctx->token_atual.tipo == TOKEN_DECIMAL) {
         tipo = TIPO_DECIMAL;
     } else {
-        fprintf(stderr, "ERRO SINTÁTICO: Esperado tipo de dado na linha %d.\n", token_atual.linha);
-        erro_sintatico_encontrado = 1;
+        relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado tipo de dado na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
         return 0;
     }
-    consumir_token();
+    *no = criar_no(ctx, NO_DECLARACAO, ctx->posicao_token);
+    consumir_token(ctx);
 
     /* Lista de variáveis */
     do {
-        if (token_atual.tipo != TOKEN_ID_VARIAVEL) {
-            fprintf(stderr, "ERRO SINTÁTICO: Esperado nome de variável na linha %d.\n", token_atual.linha);
-            erro_sintatico_encontrado = 1;
+        if (ctx->token_atual.tipo != TOKEN_ID_VARIAVEL) {
+            relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado nome de variável na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
             return 0;
         }
 
-        char nome_variavel[256];
-        strcpy(nome_variavel, token_atual.lexema);
-        consumir_token();
+        const char* nome_variavel = ctx->token_atual.lexema;
+        int variavel = criar_no(ctx, NO_VARIAVEL, ctx->posicao_token);
+        anexar_filho(ctx, *no, &ultimo, variavel);
+        consumir_token(ctx);
 
                 /* Verifica limitadores de tamanho */
-        if (token_atual.tipo == TOKEN_COLCHETES_ESQ) {
-            empilhar_delimitador('[', token_atual.linha);
-            consumir_token();
+        if (ctx->token_atual.tipo == TOKEN_COLCHETES_ESQ) {
+            empilhar_delimitador(ctx, '[', ctx->token_atual.linha, ctx->token_atual.coluna);
+            consumir_token(ctx);
 
-            if (token_atual.tipo != TOKEN_LITERAL_NUMERO) {
-                fprintf(stderr, "ERRO SINTÁTICO: Esperado número no limitador de tamanho na linha %d.\n", token_atual.linha);
-                erro_sintatico_encontrado = 1;
+            if (ctx->token_atual.tipo != TOKEN_LITERAL_NUMERO) {
+                relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado número no limitador de tamanho na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
                 return 0;
             }
 
             tem_limitador = 1;
 
             if (tipo == TIPO_DECIMAL) {
-                char* ponto = strchr(token_atual.lexema, '.');
+                char* ponto = strchr(ctx->token_atual.lexema, '.');
                 if (ponto) {
                     // Caso o lexema seja "10.2" (um token único)
-                    limitador.tamanho1 = atoi(token_atual.lexema);
+                    limitador.tamanho1 = atoi(ctx->token_atual.lexema);
                     limitador.tamanho2 = atoi(ponto + 1);
-                    consumir_token(); // Consome o token "10.2"
+                    consumir_token(ctx); // Consome o token "10.2"
                 } else {
                     // Caso o lexema seja apenas a parte inteira "10"
-                    limitador.tamanho1 = atoi(token_atual.lexema);
-                    consumir_token(); // Consome o "10"
+                    limitador.tamanho1 = atoi(ctx->token_atual.lexema);
+                    consumir_token(ctx); // Consome o "10"
                     // E verifica se o próximo token é um ponto
-                    if (token_atual.tipo == TOKEN_PONTO) {
-                        consumir_token(); // Consome o "."
-                        if (token_atual.tipo != TOKEN_LITERAL_NUMERO) {
-                            fprintf(stderr, "ERRO SINTÁTICO: Esperado número após ponto no limitador decimal na linha %d.\n", token_atual.linha);
-                            erro_sintatico_encontrado = 1;
+                    if (ctx->token_atual.tipo == TOKEN_PONTO) {
+                        consumir_token(ctx); // Consome o "."
+                        if (ctx->token_atual.tipo != TOKEN_LITERAL_NUMERO) {
+                            relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado número após ponto no limitador decimal na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
                             return 0;
                         }
-                        limitador.tamanho2 = atoi(token_atual.lexema);
-                        consumir_token(); // Consome a parte decimal "2"
+                        limitador.tamanho2 = atoi(ctx->token_atual.lexema);
+                        consumir_token(ctx); // Consome a parte decimal "2"
                     }
                 }
             } else {
                 // Lógica original para tipos texto e inteiro
-                limitador.tamanho1 = atoi(token_atual.lexema);
-                consumir_token();
+                limitador.tamanho1 = atoi(ctx->token_atual.lexema);
+                consumir_token(ctx);
             }
 
-            if (!esperar_token(TOKEN_COLCHETES_DIR)) return 0;
-            if (!desempilhar_delimitador(']', token_atual.linha - 1)) return 0;
+            if (!esperar_token(ctx, TOKEN_COLCHETES_DIR)) return 0;
+            if (!desempilhar_delimitador(ctx, ']', ctx->token_anterior.linha, ctx->token_anterior.coluna)) return 0;
         }
 
         /* Adiciona variável na tabela de símbolos */
-        adicionar_variavel(nome_variavel, tipo, funcao_escopo, limitador, tem_limitador);
+        adicionar_variavel(ctx, nome_variavel, tipo, funcao_escopo, limitador, tem_limitador);
 
         /* Atribuição inicial (opcional) */
-        if (token_atual.tipo == TOKEN_ATRIBUICAO) {
-            consumir_token();
-            if (!analisar_expressao()) return 0;
+        if (ctx->token_atual.tipo == TOKEN_ATRIBUICAO) {
+            consumir_token(ctx);
+            int valor;
+            if (!analisar_expressao(ctx, &valor)) return 0;
+            CAMPO_NO(ctx->arvore, primeiros_filhos, variavel) = valor;
         }
 
-        if (token_atual.tipo == TOKEN_VIRGULA) {
-            consumir_token();
+        if (ctx->token_atual.tipo == TOKEN_VIRGULA) {
+            consumir_token(ctx);
         } else {
             break;
         }
     } while (1);
 
-    if (!esperar_token(TOKEN_PONTO_VIRGULA)) return 0;
+    if (!esperar_token(ctx, TOKEN_PONTO_VIRGULA)) return 0;
+    return 1;
+}
+
+/* Entra em mais um nível de recursão; no limite, relata o erro e recusa. */
+static int entrar_aninhamento(ContextoCompilador* ctx) {
+    if (ctx->profundidade_aninhamento >= LIMITE_ANINHAMENTO) {
+        relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Aninhamento excessivo (mais de %d níveis) na linha %d, coluna %d.\n",
+                LIMITE_ANINHAMENTO, ctx->token_atual.linha, ctx->token_atual.coluna);
+        return 0;
+    }
+    ctx->profundidade_aninhamento++;
+    return 1;
+}
+
+/* Analisa o comando ou bloco que forma o corpo de 'se', 'senao' e 'para'. */
+static int analisar_corpo_comando(ContextoCompilador* ctx, const char* funcao_escopo, int* no) {
+    if (!entrar_aninhamento(ctx)) return 0;
+    int sucesso = ctx->token_atual.tipo == TOKEN_CHAVES_ESQ
+                ? analisar_bloco(ctx, funcao_escopo, no)
+                : analisar_comando(ctx, funcao_escopo, no);
+    ctx->profundidade_aninhamento--;
+    return sucesso;
+}
+
+/* Analisa argumentos até ')' (exclusive), anexando cada expressão ao nó. */
+static int analisar_argumentos(ContextoCompilador* ctx, int no) {
+    int ultimo = NO_NULO;
+    if (ctx->token_atual.tipo != TOKEN_PARENTESES_DIR) {
+        do {
+            int argumento;
+            if (!analisar_expressao(ctx, &argumento)) return 0;
+            anexar_filho(ctx, no, &ultimo, argumento);
+
+            if (ctx->token_atual.tipo == TOKEN_VIRGULA) {
+                consumir_token(ctx);
+            } else {
+                break;
+            }
+        } while (1);
+    }
     return 1;
 }
 
-int analisar_comando(const char* funcao_escopo) {
-    switch (token_atual.tipo) {
+int analisar_comando(ContextoCompilador* ctx, const char* funcao_escopo, int* no) {
+    int ultimo = NO_NULO;
+    int filho;
+    *no = NO_NULO;
+
+    switch (ctx->token_atual.tipo) {
         case TOKEN_LEIA:
-            consumir_token();
-            if (!esperar_token(TOKEN_PARENTESES_ESQ)) return 0;
-            empilhar_delimitador('(', token_atual.linha - 1);
+            *no = criar_no(ctx, NO_LEIA, ctx->posicao_token);
+            consumir_token(ctx);
+            if (!esperar_token(ctx, TOKEN_PARENTESES_ESQ)) return 0;
+            empilhar_delimitador(ctx, '(', ctx->token_anterior.linha, ctx->token_anterior.coluna);
 
             /* Lista de variáveis */
             do {
-                if (token_atual.tipo != TOKEN_ID_VARIAVEL) {
-                    fprintf(stderr, "ERRO SINTÁTICO: Esperado nome de variável na linha %d.\n", token_atual.linha);
-                    erro_sintatico_encontrado = 1;
+                if (ctx->token_atual.tipo != TOKEN_ID_VARIAVEL) {
+                    relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado nome de variável na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
                     return 0;
                 }
 
                 // Verificação semântica da variável
-                verificar_variavel_declarada(token_atual.lexema, token_atual.linha);
+                verificar_variavel_declarada(ctx, ctx->token_atual.lexema, ctx->token_atual.linha, ctx->token_atual.coluna);
 
-                consumir_token();
+                anexar_filho(ctx, *no, &ultimo, criar_no(ctx, NO_VARIAVEL, ctx->posicao_token));
+                consumir_token(ctx);
 
-                if (token_atual.tipo == TOKEN_VIRGULA) {
-                    consumir_token();
+                if (ctx->token_atual.tipo == TOKEN_VIRGULA) {
+                    consumir_token(ctx);
                 } else {
                     break;
                 }
             } while (1);
 
-            if (!esperar_token(TOKEN_PARENTESES_DIR)) return 0;
-            if (!desempilhar_delimitador(')', token_atual.linha - 1)) return 0;
+            if (!esperar_token(ctx, TOKEN_PARENTESES_DIR)) return 0;
+            if (!desempilhar_delimitador(ctx, ')', ctx->token_anterior.linha, ctx->token_anterior.coluna)) return 0;
 
-            if (!esperar_token(TOKEN_PONTO_VIRGULA)) return 0;
+            if (!esperar_token(ctx, TOKEN_PONTO_VIRGULA)) return 0;
             break;
 
         case TOKEN_ESCREVA:
-            consumir_token();
-            if (!esperar_token(TOKEN_PARENTESES_ESQ)) return 0;
-            empilhar_delimitador('(', token_atual.linha - 1);
-
-            // Verifica se existem argumentos para serem analisados
-            if (token_atual.tipo != TOKEN_PARENTESES_DIR) {
-                do {
-                    // Agora, qualquer expressão válida pode ser um argumento
-                    if (!analisar_expressao()) return 0;
-
-                    if (token_atual.tipo == TOKEN_VIRGULA) {
-                        consumir_token();
-                    } else {
-                        break;
-                    }
-                } while (1);
-            }
+            *no = criar_no(ctx, NO_ESCREVA, ctx->posicao_token);
+            consumir_token(ctx);
+            if (!esperar_token(ctx, TOKEN_PARENTESES_ESQ)) return 0;
+            empilhar_delimitador(ctx, '(', ctx->token_anterior.linha, ctx->token_anterior.coluna);
+
+            // Qualquer expressão válida pode ser um argumento
+            if (!analisar_argumentos(ctx, *no)) return 0;
 
-            if (!esperar_token(TOKEN_PARENTESES_DIR)) return 0;
-            if (!desempilhar_delimitador(')', token_atual.linha - 1)) return 0;
-            if (!esperar_token(TOKEN_PONTO_VIRGULA)) return 0;
+            if (!esperar_token(ctx, TOKEN_PARENTESES_DIR)) return 0;
+            if (!desempilhar_delimitador(ctx, ')', ctx->token_anterior.linha, ctx->token_anterior.coluna)) return 0;
+            if (!esperar_token(ctx, TOKEN_PONTO_VIRGULA)) return 0;
             break;
 
         case TOKEN_SE:
-            consumir_token();
-            if (!esperar_token(TOKEN_PARENTESES_ESQ)) return 0;
-            empilhar_delimitador('(', token_atual.linha - 1);
+            *no = criar_no(ctx, NO_SE, ctx->posicao_token);
+            consumir_token(ctx);
+            if (!esperar_token(ctx, TOKEN_PARENTESES_ESQ)) return 0;
+            empilhar_delimitador(ctx, '(', ctx->token_anterior.linha, ctx->token_anterior.coluna);
 
-            if (!analisar_condicao()) return 0;
+            if (!analisar_condicao(ctx, &filho)) return 0;
+            anexar_filho(ctx, *no, &ultimo, filho);
 
-            if (!esperar_token(TOKEN_PARENTESES_DIR)) return 0;
-            if (!desempilhar_delimitador(')', token_atual.linha - 1)) return 0;
+            if (!esperar_token(ctx, TOKEN_PARENTESES_DIR)) return 0;
+            if (!desempilhar_delimitador(ctx, ')', ctx->token_anterior.linha, ctx->token_anterior.coluna)) return 0;
 
             /* Verificar que não há ponto e vírgula após se(...) */
-            if (!verificar_ausencia_token(TOKEN_PONTO_VIRGULA, "condição do 'se'")) return 0;
+            if (!verificar_ausencia_token(ctx, TOKEN_PONTO_VIRGULA, "condição do 'se'")) return 0;
 
             /* Comando verdadeiro */
-            if (token_atual.tipo == TOKEN_CHAVES_ESQ) {
-                if (!analisar_bloco(funcao_escopo)) return 0;
-            } else {
-                if (!analisar_comando(funcao_escopo)) return 0;
-            }
+            if (!analisar_corpo_comando(ctx, funcao_escopo, &filho)) return 0;
+            anexar_filho(ctx, *no, &ultimo, filho);
 
             /* Senao (opcional) */
-            if (token_atual.tipo == TOKEN_SENAO) {
-                consumir_token();
-                if (token_atual.tipo == TOKEN_CHAVES_ESQ) {
-                    if (!analisar_bloco(funcao_escopo)) return 0;
-                } else {
-                    if (!analisar_comando(funcao_escopo)) return 0;
-                }
+            if (ctx->token_atual.tipo == TOKEN_SENAO) {
+                consumir_token(ctx);
+                if (!analisar_corpo_comando(ctx, funcao_escopo, &filho)) return 0;
+                anexar_filho(ctx, *no, &ultimo, filho);
             }
             break;
 
         case TOKEN_PARA:
-            consumir_token();
-            if (!esperar_token(TOKEN_PARENTESES_ESQ)) return 0;
-            empilhar_delimitador('(', token_atual.linha - 1);
+            *no = criar_no(ctx, NO_PARA, ctx->posicao_token);
+            consumir_token(ctx);
+            if (!esperar_token(ctx, TOKEN_PARENTESES_ESQ)) return 0;
+            empilhar_delimitador(ctx, '(', ctx->token_anterior.linha, ctx->token_anterior.coluna);
 
             /* Inicialização */
-            if (token_atual.tipo == TOKEN_ID_VARIAVEL) {
-                consumir_token();
-                if (!esperar_token(TOKEN_ATRIBUICAO)) return 0;
-                if (!analisar_expressao()) return 0;
+            if (ctx->token_atual.tipo == TOKEN_ID_VARIAVEL) {
+                filho = criar_no(ctx, NO_ATRIBUICAO, ctx->posicao_token);
+                consumir_token(ctx);
+                if (!esperar_token(ctx, TOKEN_ATRIBUICAO)) return 0;
+                int valor;
+                if (!analisar_expressao(ctx, &valor)) return 0;
+                CAMPO_NO(ctx->arvore, primeiros_filhos, filho) = valor;
+            } else {
+                filho = criar_no(ctx, NO_VAZIO, ctx->posicao_token);
             }
+            anexar_filho(ctx, *no, &ultimo, filho);
 
-            if (!esperar_token(TOKEN_PONTO_VIRGULA)) return 0;
+            if (!esperar_token(ctx, TOKEN_PONTO_VIRGULA)) return 0;
 
             /* Condição */
-            if (!analisar_condicao()) return 0;
-            if (!esperar_token(TOKEN_PONTO_VIRGULA)) return 0;
+            if (!analisar_condicao(ctx, &filho)) return 0;
+            anexar_filho(ctx, *no, &ultimo, filho);
+            if (!esperar_token(ctx, TOKEN_PONTO_VIRGULA)) return 0;
 
             /* Incremento */
-            if (token_atual.tipo == TOKEN_ID_VARIAVEL) {
-                /* Variável seguida de atribuição ou incremento/decremento */
-                char nome_var[256];
-                strcpy(nome_var, token_atual.lexema);
-                consumir_token();
-
-                if (token_atual.tipo == TOKEN_ATRIBUICAO) {
-                    consumir_token();
-                    if (!analisar_expressao()) return 0;
-                } else if (token_atual.tipo == TOKEN_INCREMENT || token_atual.tipo == TOKEN_DECREMENT) {
-                    consumir_token(); /* Consome ++ ou -- */
+            if (ctx->token_atual.tipo == TOKEN_ID_VARIAVEL) {
+                /* Variável seguida de atribuição ou incremento/decremento: decidido antes de consumir */
+                TipoToken seguinte = espiar_token(ctx, 1)->tipo;
+                int variavel = ctx->posicao_token;
+
+                if (seguinte == TOKEN_ATRIBUICAO) {
+                    filho = criar_no(ctx, NO_ATRIBUICAO, variavel);
+                    consumir_token(ctx);
+                    consumir_token(ctx); /* Consome o '=' */
+                    int valor;
+                    if (!analisar_expressao(ctx, &valor)) return 0;
+                    CAMPO_NO(ctx->arvore, primeiros_filhos, filho) = valor;
+                } else if (seguinte == TOKEN_INCREMENT || seguinte == TOKEN_DECREMENT) {
+                    filho = criar_no(ctx, NO_INCREMENTO, variavel + 1);
+                    int alvo = criar_no(ctx, NO_VARIAVEL, variavel);
+                    CAMPO_NO(ctx->arvore, primeiros_filhos, filho) = alvo;
+                    consumir_token(ctx);
+                    consumir_token(ctx); /* Consome ++ ou -- */
                 } else {
-                    fprintf(stderr, "ERRO SINTÁTICO: Esperado atribuição ou incremento/decremento na terceira parte do 'para' na linha %d.\n", token_atual.linha);
-                    erro_sintatico_encontrado = 1;
+                    consumir_token(ctx);
+                    relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado atribuição ou incremento/decremento na terceira parte do 'para' na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
                     return 0;
                 }
-            } else if (token_atual.tipo == TOKEN_INCREMENT || token_atual.tipo == TOKEN_DECREMENT) {
+            } else if (ctx->token_atual.tipo == TOKEN_INCREMENT || ctx->token_atual.tipo == TOKEN_DECREMENT) {
                 /* Incremento/decremento antes da variável */
-                consumir_token();
-                if (token_atual.tipo != TOKEN_ID_VARIAVEL) {
-                    fprintf(stderr, "ERRO SINTÁTICO: Esperado nome de variável após incremento/decremento na linha %d.\n", token_atual.linha);
-                    erro_sintatico_encontrado = 1;
+                filho = criar_no(ctx, NO_INCREMENTO, ctx->posicao_token);
+                consumir_token(ctx);
+                if (ctx->token_atual.tipo != TOKEN_ID_VARIAVEL) {
+                    relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado nome de variável após incremento/decremento na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
                     return 0;
                 }
-                consumir_token();
+                int alvo = criar_no(ctx, NO_VARIAVEL, ctx->posicao_token);
+                CAMPO_NO(ctx->arvore, primeiros_filhos, filho) = alvo;
+                consumir_token(ctx);
+            } else {
+                filho = criar_no(ctx, NO_VAZIO, ctx->posicao_token);
             }
+            anexar_filho(ctx, *no, &ultimo, filho);
 
-            if (!esperar_token(TOKEN_PARENTESES_DIR)) return 0;
-            if (!desempilhar_delimitador(')', token_atual.linha - 1)) return 0;
+            if (!esperar_token(ctx, TOKEN_PARENTESES_DIR)) return 0;
+            if (!desempilhar_delimitador(ctx, ')', ctx->token_anterior.linha, ctx->token_anterior.coluna)) return 0;
 
             /* Verificar que não há ponto e vírgula após para(...) */
-            if (!verificar_ausencia_token(TOKEN_PONTO_VIRGULA, "declaração do 'para'")) return 0;
+            if (!verificar_ausencia_token(ctx, TOKEN_PONTO_VIRGULA, "declaração do 'para'")) return 0;
 
             /* Corpo do laço */
-            if (token_atual.tipo == TOKEN_CHAVES_ESQ) {
-                if (!analisar_bloco(funcao_escopo)) return 0;
-            } else {
-                if (!analisar_comando(funcao_escopo)) return 0;
-            }
+            if (!analisar_corpo_comando(ctx, funcao_escopo, &filho)) return 0;
+            anexar_filho(ctx, *no, &ultimo, filho);
             break;
 
         case TOKEN_RETORNO:
-            consumir_token();
-            if (!analisar_expressao()) return 0;
-            if (!esperar_token(TOKEN_PONTO_VIRGULA)) return 0;
+            *no = criar_no(ctx, NO_RETORNO, ctx->posicao_token);
+            consumir_token(ctx);
+            if (!analisar_expressao(ctx, &filho)) return 0;
+            anexar_filho(ctx, *no, &ultimo, filho);
+            if (!esperar_token(ctx, TOKEN_PONTO_VIRGULA)) return 0;
             break;
 
         case TOKEN_ID_VARIAVEL:
             /* Atribuição */
         {
-            char nome_var[256];
-            strcpy(nome_var, token_atual.lexema);
-            int linha_atribuicao = token_atual.linha;
-            consumir_token();
-            if (!esperar_token(TOKEN_ATRIBUICAO)) return 0;
-
-            // Captura informações do valor para análise semântica
-            char valor[256];
-            TipoToken tipo_valor = token_atual.tipo;
-            strcpy(valor, token_atual.lexema);
+            /* Variável, '=' e o início do valor: o valor é guardado por referência ao lexema canônico */
+            Token variavel = ctx->token_atual;
+            Token valor = *espiar_token(ctx, 2);
+            *no = criar_no(ctx, NO_ATRIBUICAO, ctx->posicao_token);
+            consumir_token(ctx);
+            if (!esperar_token(ctx, TOKEN_ATRIBUICAO)) return 0;
 
-            if (!analisar_expressao()) return 0;
+            if (!analisar_expressao(ctx, &filho)) return 0;
+            anexar_filho(ctx, *no, &ultimo, filho);
 
             // Análise semântica da atribuição
-            analisar_semantica_atribuicao(nome_var, valor, tipo_valor, linha_atribuicao);
+            analisar_semantica_atribuicao(ctx, variavel.lexema, valor.lexema, valor.tipo, variavel.linha, variavel.coluna);
 
-            if (!esperar_token(TOKEN_PONTO_VIRGULA)) return 0;
+            if (!esperar_token(ctx, TOKEN_PONTO_VIRGULA)) return 0;
         }
             break;
 
         case TOKEN_ID_FUNCAO:
             /* Chamada de função */
         {
-            char nome_funcao[256];
-            strcpy(nome_funcao, token_atual.lexema);
-            int linha_chamada = token_atual.linha;
-            consumir_token();
+            const char* nome_funcao = ctx->token_atual.lexema;
+            int linha_chamada = ctx->token_atual.linha;
+            int coluna_chamada = ctx->token_atual.coluna;
+            *no = criar_no(ctx, NO_CHAMADA, ctx->posicao_token);
+            consumir_token(ctx);
 
             // Verificação semântica da função
-            verificar_funcao_declarada(nome_funcao, linha_chamada);
+            verificar_funcao_declarada(ctx, nome_funcao, linha_chamada, coluna_chamada);
 
-            if (!esperar_token(TOKEN_PARENTESES_ESQ)) return 0;
-            empilhar_delimitador('(', token_atual.linha - 1);
+            if (!esperar_token(ctx, TOKEN_PARENTESES_ESQ)) return 0;
+            empilhar_delimitador(ctx, '(', ctx->token_anterior.linha, ctx->token_anterior.coluna);
 
             /* Parâmetros (opcional) */
-            if (token_atual.tipo != TOKEN_PARENTESES_DIR) {
-                do {
-                    if (!analisar_expressao()) return 0;
-
-                    if (token_atual.tipo == TOKEN_VIRGULA) {
-                        consumir_token();
-                    } else {
-                        break;
-                    }
-                } while (1);
-            }
+            if (!analisar_argumentos(ctx, *no)) return 0;
 
-            if (!esperar_token(TOKEN_PARENTESES_DIR)) return 0;
-            if (!desempilhar_delimitador(')', token_atual.linha - 1)) return 0;
-            if (!esperar_token(TOKEN_PONTO_VIRGULA)) return 0;
+            if (!esperar_token(ctx, TOKEN_PARENTESES_DIR)) return 0;
+            if (!desempilhar_delimitador(ctx, ')', ctx->token_anterior.linha, ctx->token_anterior.coluna)) return 0;
+            if (!esperar_token(ctx, TOKEN_PONTO_VIRGULA)) return 0;
         }
             break;
+
+        default:
+            relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Token inesperado '%s' na linha %d, coluna %d. Esperado comando ou declaração de variável.\n",
+                    ctx->token_atual.lexema, ctx->token_atual.linha, ctx->token_atual.coluna);
+            return 0;
     }
+
+    return 1;
 }
-int analisar_bloco(const char* funcao_escopo) {
-    if (token_atual.tipo != TOKEN_CHAVES_ESQ) {
-         fprintf(stderr, "ERRO SINTÁTICO: Esperado '{' para iniciar o bloco na linha %d.\n", token_atual.linha);
-         erro_sintatico_encontrado = 1;
+
+int analisar_bloco(ContextoCompilador* ctx, const char* funcao_escopo, int* no) {
+    if (ctx->token_atual.tipo != TOKEN_CHAVES_ESQ) {
+         relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado '{' para iniciar o bloco na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
          return 0;
     }
-    empilhar_delimitador('{', token_atual.linha);
-    consumir_token();
+    *no = criar_no(ctx, NO_BLOCO, ctx->posicao_token);
+    int ultimo = NO_NULO;
+    empilhar_delimitador(ctx, '{', ctx->token_atual.linha, ctx->token_atual.coluna);
+    consumir_token(ctx);
+
+    /* 'funcao' e 'principal' nunca aparecem dentro de um bloco: indicam um '}' faltando. */
+    while (ctx->token_atual.tipo != TOKEN_CHAVES_DIR && ctx->token_atual.tipo != TOKEN_FIM_DE_ARQUIVO &&
+           ctx->token_atual.tipo != TOKEN_ERRO && ctx->token_atual.tipo != TOKEN_FUNCAO &&
+           ctx->token_atual.tipo != TOKEN_PRINCIPAL && !analise_interrompida(ctx)) {
+        int filho;
+        int topo_pilha = ctx->pilha_balanceamento->topo;
+        int sucesso;
+
+        if (ctx->token_atual.tipo == TOKEN_INTEIRO || ctx->token_atual.tipo == TOKEN_TEXTO || ctx->token_atual.tipo == TOKEN_DECIMAL) {
+            sucesso = analisar_declaracao_variavel(ctx, funcao_escopo, &filho);
+        } else {
+            sucesso = analisar_comando(ctx, funcao_escopo, &filho);
+        }
 
-    while (token_atual.tipo != TOKEN_CHAVES_DIR && token_atual.tipo != TOKEN_FIM_DE_ARQUIVO && !erro_sintatico_encontrado) {
-        if (token_atual.tipo == TOKEN_INTEIRO || token_atual.tipo == TOKEN_TEXTO || token_atual.tipo == TOKEN_DECIMAL) {
-            if (!analisar_declaracao_variavel(funcao_escopo)) return 0;
+        if (sucesso) {
+            anexar_filho(ctx, *no, &ultimo, filho);
         } else {
-            if (!analisar_comando(funcao_escopo)) return 0;
+            recuperar_de_erro(ctx, topo_pilha);
         }
     }
 
-    if (!esperar_token(TOKEN_CHAVES_DIR)) return 0;
-    if (!desempilhar_delimitador('}', token_atual.linha - 1)) return 0;
+    if (!esperar_token(ctx, TOKEN_CHAVES_DIR)) return 0;
+    if (!desempilhar_delimitador(ctx, '}', ctx->token_anterior.linha, ctx->token_anterior.coluna)) return 0;
 
     return 1;
 }
 
-int analisar_expressao() {
-    /* Expressão: Termo ((+|-) Termo)* */
-    if (!analisar_termo()) return 0;
+/*
+ * Lê uma sequência de operadores associativos à direita de mesma precedência,
+ * a partir do operador atual, e substitui '*no' (o primeiro operando) pela
+ * cadeia 'a ^ (b ^ (c ^ ...))'. Os operandos são lidos em laço e os nós só
+ * são criados ao fim da sequência, da direita para a esquerda, na mesma ordem
+ * da versão recursiva. Os operadores associativos à direita da tabela são
+ * aritméticos: não há verificação relacional nem lógica a fazer.
+ */
+static int analisar_operacao(ContextoCompilador* ctx, Precedencia minima, int* logicos, int* no);
 
-    while (token_atual.tipo == TOKEN_OP_SOMA || token_atual.tipo == TOKEN_OP_SUBTRACAO) {
-        consumir_token();
-        if (!analisar_termo()) return 0;
-    }
+static int analisar_sequencia_direita(ContextoCompilador* ctx, int* logicos, int* no) {
+    PilhaOperacoes* pilha = &ctx->operacoes_direita;
+    int base = pilha->total; /* Uma sequência pode conter outra entre parênteses. */
+    Precedencia precedencia = operadores_binarios[ctx->token_atual.tipo].precedencia;
+    int direito = *no;
 
+    do {
+        empilhar_operacao(ctx, ctx->posicao_token, direito);
+        consumir_token(ctx);
+        if (!analisar_operacao(ctx, precedencia + 1, logicos, &direito)) {
+            pilha->total = base;
+            return 0;
+        }
+    } while (operadores_binarios[ctx->token_atual.tipo].precedencia == precedencia);
+
+    while (pilha->total > base) {
+        pilha->total -= 2;
+        direito = criar_no_binario(ctx, pilha->itens[pilha->total], pilha->itens[pilha->total + 1], direito);
+    }
+    *no = direito;
     return 1;
 }
 
-int analisar_termo() {
-    /* Termo: Fator ((*|/|^) Fator)* */
-    if (!analisar_fator()) return 0;
+/*
+ * Precedence climbing: lê um fator e aplica os operadores da tabela com
+ * precedência >= 'minima'. Só recursiona para o operando direito, logo o
+ * custo por operando é uma chamada, e não uma por nível de precedência;
+ * sequências associativas à direita são lidas em laço, sem recursão.
+ * 'logicos' conta os '&&'/'||' lidos (NULL fora de condições, onde
+ * 'minima' já exclui operadores lógicos).
+ */
+static int analisar_operacao(ContextoCompilador* ctx, Precedencia minima, int* logicos, int* no) {
+    int inicio = ctx->posicao_token;
+    Precedencia precedencia_esquerda = PRECEDENCIA_OPERANDO;
+
+    if (!analisar_fator(ctx, no)) return 0;
+
+    while (1) {
+        const OperadorBinario* op = &operadores_binarios[ctx->token_atual.tipo];
+
+        if (op->precedencia == PRECEDENCIA_NENHUMA || op->precedencia < minima) break;
+        /* Operando esquerdo mais fraco que o operador: 'a < b < c', 'a < b && c < d < e' */
+        if (precedencia_esquerda < op->precedencia ||
+            (precedencia_esquerda == op->precedencia && op->associatividade == NAO_ASSOCIATIVO)) break;
+
+        if (op->precedencia < PRECEDENCIA_RELACIONAL && !eh_comparacao(ctx, *no)) {
+            relatar_erro_sintatico(ctx, *logicos == 0
+                    ? "ERRO SINTÁTICO: Esperado operador relacional na condição na linha %d, coluna %d.\n"
+                    : "ERRO SINTÁTICO: Esperado operador relacional após operador lógico na linha %d, coluna %d.\n",
+                    ctx->token_atual.linha, ctx->token_atual.coluna);
+            return 0;
+        }
+
+        if (op->associatividade == ASSOCIATIVO_DIREITA) {
+            if (!analisar_sequencia_direita(ctx, logicos, no)) return 0;
+            precedencia_esquerda = op->precedencia;
+            continue;
+        }
 
-    while (token_atual.tipo == TOKEN_OP_MULTIPLICACAO ||
-           token_atual.tipo == TOKEN_OP_DIVISAO ||
-           token_atual.tipo == TOKEN_OP_EXPONENCIACAO) {
-        consumir_token();
-        if (!analisar_fator()) return 0;
+        int operador = ctx->posicao_token;
+        int direito;
+        consumir_token(ctx);
+        if (op->precedencia < PRECEDENCIA_RELACIONAL) (*logicos)++;
+
+        int inicio_direito = ctx->posicao_token;
+        if (!analisar_operacao(ctx, op->precedencia + 1, logicos, &direito)) return 0;
+
+        if (op->precedencia < PRECEDENCIA_RELACIONAL && !eh_comparacao(ctx, direito)) {
+            relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado operador relacional após operador lógico na linha %d, coluna %d.\n",
+                    ctx->token_atual.linha, ctx->token_atual.coluna);
+            return 0;
+        }
+
+        *no = criar_no_binario(ctx, operador, *no, direito);
+        precedencia_esquerda = op->precedencia;
+
+        if (op->precedencia == PRECEDENCIA_RELACIONAL) {
+            /* Verificação semântica da comparação, pelo primeiro token de cada lado */
+            Token esquerdo = token_na_posicao(ctx, inicio);
+            Token segundo = token_na_posicao(ctx, inicio_direito);
+            analisar_semantica_comparacao(ctx, esquerdo.lexema, esquerdo.tipo, segundo.lexema, segundo.tipo,
+                                          token_na_posicao(ctx, operador).lexema, esquerdo.linha, esquerdo.coluna);
+        }
     }
 
     return 1;
 }
 
-int analisar_fator() {
+int analisar_expressao(ContextoCompilador* ctx, int* no) {
+    /* Expressão: Fator (OperadorMatematico Fator)* */
+    /* Parênteses e argumentos de chamada voltam aqui: é o ponto de recursão das expressões. */
+    if (!entrar_aninhamento(ctx)) return 0;
+    int sucesso = analisar_operacao(ctx, PRECEDENCIA_ADITIVA, NULL, no);
+    ctx->profundidade_aninhamento--;
+    return sucesso;
+}
+
+int analisar_fator(ContextoCompilador* ctx, int* no) {
     /* Fator: NUMERO | VARIAVEL | TEXTO | FUNCAO(...) | (Expressao) */
 
-    if (token_atual.tipo == TOKEN_LITERAL_NUMERO || token_atual.tipo == TOKEN_LITERAL_TEXTO) {
-        consumir_token();
+    if (ctx->token_atual.tipo == TOKEN_LITERAL_NUMERO || ctx->token_atual.tipo == TOKEN_LITERAL_TEXTO) {
+        *no = criar_no(ctx, ctx->token_atual.tipo == TOKEN_LITERAL_NUMERO ? NO_NUMERO : NO_TEXTO, ctx->posicao_token);
+        consumir_token(ctx);
         return 1;
     }
-    else if (token_atual.tipo == TOKEN_ID_VARIAVEL) {
+    else if (ctx->token_atual.tipo == TOKEN_ID_VARIAVEL) {
         // Verificação semântica da variável
-        verificar_variavel_declarada(token_atual.lexema, token_atual.linha);
-        consumir_token();
+        verificar_variavel_declarada(ctx, ctx->token_atual.lexema, ctx->token_atual.linha, ctx->token_atual.coluna);
+        *no = criar_no(ctx, NO_VARIAVEL, ctx->posicao_token);
+        consumir_token(ctx);
         return 1;
     }
-    else if (token_atual.tipo == TOKEN_ID_FUNCAO) {
+    else if (ctx->token_atual.tipo == TOKEN_ID_FUNCAO) {
         /* Chamada de função */
-        char nome_funcao[256];
-        strcpy(nome_funcao, token_atual.lexema);
-        int linha_chamada = token_atual.linha;
-        consumir_token();
+        const char* nome_funcao = ctx->token_atual.lexema;
+        int linha_chamada = ctx->token_atual.linha;
+        int coluna_chamada = ctx->token_atual.coluna;
+        *no = criar_no(ctx, NO_CHAMADA, ctx->posicao_token);
+        consumir_token(ctx);
 
         // Verificação semântica da função
-        verificar_funcao_declarada(nome_funcao, linha_chamada);
+        verificar_funcao_declarada(ctx, nome_funcao, linha_chamada, coluna_chamada);
 
-        if (!esperar_token(TOKEN_PARENTESES_ESQ)) return 0;
-        empilhar_delimitador('(', token_atual.linha - 1);
+        if (!esperar_token(ctx, TOKEN_PARENTESES_ESQ)) return 0;
+        empilhar_delimitador(ctx, '(', ctx->token_anterior.linha, ctx->token_anterior.coluna);
 
         /* Parâmetros (opcional) */
-        if (token_atual.tipo != TOKEN_PARENTESES_DIR) {
-            do {
-                if (!analisar_expressao()) return 0;
+        if (!analisar_argumentos(ctx, *no)) return 0;
 
-                if (token_atual.tipo == TOKEN_VIRGULA) {
-                    consumir_token();
-                } else {
-                    break;
-                }
-            } while (1);
-        }
-
-        if (!esperar_token(TOKEN_PARENTESES_DIR)) return 0;
-        if (!desempilhar_delimitador(')', token_atual.linha - 1)) return 0;
+        if (!esperar_token(ctx, TOKEN_PARENTESES_DIR)) return 0;
+        if (!desempilhar_delimitador(ctx, ')', ctx->token_anterior.linha, ctx->token_anterior.coluna)) return 0;
         return 1;
     }
-    else if (token_atual.tipo == TOKEN_PARENTESES_ESQ) {
-        /* (Expressão) */
-        empilhar_delimitador('(', token_atual.linha);
-        consumir_token();
+    else if (ctx->token_atual.tipo == TOKEN_PARENTESES_ESQ) {
+        /* (Expressão): os parênteses não geram nó */
+        empilhar_delimitador(ctx, '(', ctx->token_atual.linha, ctx->token_atual.coluna);
+        consumir_token(ctx);
 
-        if (!analisar_expressao()) return 0;
+        if (!analisar_expressao(ctx, no)) return 0;
 
-        if (!esperar_token(TOKEN_PARENTESES_DIR)) return 0;
-        if (!desempilhar_delimitador(')', token_atual.linha - 1)) return 0;
+        if (!esperar_token(ctx, TOKEN_PARENTESES_DIR)) return 0;
+        if (!desempilhar_delimitador(ctx, ')', ctx->token_anterior.linha, ctx->token_anterior.coluna)) return 0;
         return 1;
     }
     else {
-        fprintf(stderr, "ERRO SINTÁTICO: Fator inválido '%s' na linha %d.\n",
-                token_atual.lexema, token_atual.linha);
-        erro_sintatico_encontrado = 1;
+        relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Fator inválido '%s' na linha %d, coluna %d.\n",
+                ctx->token_atual.lexema, ctx->token_atual.linha, ctx->token_atual.coluna);
         return 0;
     }
 }
 
 
-int analisar_condicao() {
-    /* Captura informações do primeiro operando */
-    char operando1[256];
-    TipoToken tipo_operando1 = token_atual.tipo;
-    strcpy(operando1, token_atual.lexema);
-    int linha_comparacao = token_atual.linha;
-
-    /* Primeira expressão */
-    if (!analisar_expressao()) return 0;
-
-    /* Operador relacional */
-    if (token_atual.tipo == TOKEN_OP_IGUAL || token_atual.tipo == TOKEN_OP_DIFERENTE ||
-        token_atual.tipo == TOKEN_OP_MENOR || token_atual.tipo == TOKEN_OP_MENOR_IGUAL ||
-        token_atual.tipo == TOKEN_OP_MAIOR || token_atual.tipo == TOKEN_OP_MAIOR_IGUAL) {
-
-        char operador[4];
-        strcpy(operador, token_atual.lexema);
-        consumir_token();
-
-        /* Captura informações do segundo operando */
-        char operando2[256];
-        TipoToken tipo_operando2 = token_atual.tipo;
-        strcpy(operando2, token_atual.lexema);
-
-        /* Segunda expressão */
-        if (!analisar_expressao()) return 0;
-
-        /* Verificação semântica da comparação */
-        analisar_semantica_comparacao(operando1, tipo_operando1, operando2, tipo_operando2, operador, linha_comparacao);
-
-        /* Operadores lógicos (opcional) */
-        while (token_atual.tipo == TOKEN_OP_E || token_atual.tipo == TOKEN_OP_OU) {
-            consumir_token();
-
-            /* Captura próximo operando */
-            strcpy(operando1, token_atual.lexema);
-            tipo_operando1 = token_atual.tipo;
-            linha_comparacao = token_atual.linha;
-
-            /* Nova condição relacional */
-            if (!analisar_expressao()) return 0;
-
-            if (token_atual.tipo == TOKEN_OP_IGUAL || token_atual.tipo == TOKEN_OP_DIFERENTE ||
-                token_atual.tipo == TOKEN_OP_MENOR || token_atual.tipo == TOKEN_OP_MENOR_IGUAL ||
-                token_atual.tipo == TOKEN_OP_MAIOR || token_atual.tipo == TOKEN_OP_MAIOR_IGUAL) {
+int analisar_condicao(ContextoCompilador* ctx, int* no) {
+    /* Condição: Comparacao ((&& | ||) Comparacao)*, com && mais forte que || */
+    int logicos = 0;
 
-                strcpy(operador, token_atual.lexema);
-                consumir_token();
+    if (!analisar_operacao(ctx, PRECEDENCIA_OU, &logicos, no)) return 0;
 
-                strcpy(operando2, token_atual.lexema);
-                tipo_operando2 = token_atual.tipo;
-
-                if (!analisar_expressao()) return 0;
-
-                /* Verificação semântica da comparação */
-                analisar_semantica_comparacao(operando1, tipo_operando1, operando2, tipo_operando2, operador, linha_comparacao);
-
-            } else {
-                fprintf(stderr, "ERRO SINTÁTICO: Esperado operador relacional após operador lógico na linha %d.\n", token_atual.linha);
-                erro_sintatico_encontrado = 1;
-                return 0;
-            }
-        }
-
-        return 1;
-    } else {
-        fprintf(stderr, "ERRO SINTÁTICO: Esperado operador relacional na condição na linha %d.\n", token_atual.linha);
-        erro_sintatico_encontrado = 1;
+    if (!eh_comparacao(ctx, *no)) {
+        relatar_erro_sintatico(ctx, "ERRO SINTÁTICO: Esperado operador relacional na condição na linha %d, coluna %d.\n", ctx->token_atual.linha, ctx->token_atual.coluna);
         return 0;
     }
-}
\ No newline at end of file
+
+    return 1;
+}
@@ -9,83 +9,218 @@
 
 #include "compilador.h"
 
-/* --- VARIÁVEIS GLOBAIS SEMÂNTICAS --- */
-int erro_semantico_encontrado = 0;
-int alerta_semantico_emitido = 0;
-
 /* --- ESTRUTURAS PARA ANÁLISE SEMÂNTICA --- */
 
-typedef struct {
-    char* nome_funcao;
+#define CAPACIDADE_INICIAL_FUNCOES 32
+#define CAPACIDADE_INICIAL_CHAMADAS 4
+#define TOTAL_FUNCOES_MAIS_CHAMADAS 5
+#define MAX_LINHAS_RELATORIO 8
+#define FUNCOES_POR_SLAB 16
+
+typedef struct FuncaoDeclarada {
+    const char* nome_funcao; /* Cópia canônica da tabela de nomes. */
+    int id_nome;
     int linha_declaracao;
-    int foi_chamada;
+    int coluna_declaracao;
+    int total_chamadas;
+    int* linhas_chamada;     /* Linha de cada chamada, em ordem de ocorrência. */
+    int capacidade_linhas;
     struct FuncaoDeclarada* proxima;
 } FuncaoDeclarada;
 
-typedef struct {
+/* Registro de funções: lista em ordem de declaração e índice hash pelo id do nome. */
+typedef struct TabelaFuncoes {
     FuncaoDeclarada* primeira;
     int total_funcoes;
+    FuncaoDeclarada** indice; /* Endereçamento aberto; NULL indica slot vazio. */
+    int capacidade_indice;    /* Sempre potência de 2. */
 } TabelaFuncoes;
 
-static TabelaFuncoes* tabela_funcoes = NULL;
+/* Alerta decidido por uma verificação, pronto para ser escrito por emitir_alerta(). */
+typedef enum {
+    ALERTA_NENHUM,
+    ALERTA_VARIAVEL_NAO_DECLARADA,   /* nome */
+    ALERTA_FUNCAO_NAO_DECLARADA,     /* nome */
+    ALERTA_ATRIBUICAO_INCOMPATIVEL,  /* nome, tipo1 (variável), tipo2 (valor) */
+    ALERTA_TEXTO_COM_NUMERO,         /* operador */
+    ALERTA_COMPARACAO_INCOMPATIVEL,  /* tipo1, tipo2, operador */
+    ALERTA_OPERADOR_TEXTO,           /* operador */
+    ALERTA_OPERACAO_MATEMATICA_TEXTO,/* operador */
+    ALERTA_TEXTO_EXCEDE_LIMITE,      /* nome, limite */
+    ALERTA_CASAS_ANTES_DO_PONTO,     /* nome, casas, limite */
+    ALERTA_CASAS_DEPOIS_DO_PONTO     /* nome, casas, limite */
+} TipoAlerta;
 
-/* --- INICIALIZAÇÃO --- */
+typedef struct {
+    TipoAlerta tipo;
+    const char* nome;
+    const char* operador;
+    TipoDado tipo1;
+    TipoDado tipo2;
+    int casas;
+    int limite;
+    int linha;
+    int coluna;
+} AlertaSemantico;
+
+/* Verificações registradas pelo parser no modo adiado (ver VERIFICAÇÕES ADIADAS). */
+#define CAPACIDADE_INICIAL_VERIFICACOES 32
+#define MAXIMO_VERIFICACOES_ADIADAS 512
+#define MINIMO_VERIFICACOES_POR_TAREFA 64
+#define MAXIMO_TAREFAS_VERIFICACAO (MAXIMO_VERIFICACOES_ADIADAS / MINIMO_VERIFICACOES_POR_TAREFA + 1)
+/* Abaixo disso a análise inteira leva menos que distribuir as tarefas: as verificações são feitas na hora. */
+#define MINIMO_TOKENS_VERIFICACAO_ADIADA 8192
+
+typedef enum {
+    VERIFICACAO_VARIAVEL,
+    VERIFICACAO_ATRIBUICAO,
+    VERIFICACAO_COMPARACAO,
+    VERIFICACAO_AVALIADA     /* Alerta já decidido no registro. */
+} TipoVerificacao;
 
-void inicializar_analisador_semantico() {
-    erro_semantico_encontrado = 0;
-    alerta_semantico_emitido = 0;
+typedef struct {
+    TipoVerificacao tipo;
+    const char* nome;        /* Variável verificada, destino da atribuição ou primeiro operando. */
+    const char* valor;       /* Valor atribuído ou segundo operando. */
+    const char* operador;
+    TipoToken tipo1;
+    TipoToken tipo2;
+    int linha;
+    int coluna;
+    int visiveis;            /* Variáveis declaradas até este ponto do código. */
+    int funcao;              /* Funções declaradas até aqui: agrupa as verificações por função. */
+    AlertaSemantico alerta;  /* Resultado da avaliação. */
+} VerificacaoAdiada;
+
+typedef struct VerificacoesAdiadas {
+    VerificacaoAdiada* itens; /* Alocado no primeiro registro; dobra até MAXIMO_VERIFICACOES_ADIADAS. */
+    int total;
+    int capacidade;
+} VerificacoesAdiadas;
+
+/* --- INICIALIZAÇÃO --- */
 
-    tabela_funcoes = (TabelaFuncoes*) alocar_memoria(sizeof(TabelaFuncoes));
-    tabela_funcoes->primeira = NULL;
-    tabela_funcoes->total_funcoes = 0;
+void inicializar_analisador_semantico(ContextoCompilador* ctx) {
+    ctx->erro_semantico_encontrado = 0;
+    ctx->alerta_semantico_emitido = 0;
+
+    pool_inicializar(ctx, &ctx->pool_funcoes, "FuncaoDeclarada", sizeof(FuncaoDeclarada), FUNCOES_POR_SLAB, REGIAO_SEMANTICO);
+    ctx->tabela_funcoes = (TabelaFuncoes*) alocar_na_regiao(ctx, REGIAO_SEMANTICO, sizeof(TabelaFuncoes));
+    ctx->tabela_funcoes->primeira = NULL;
+    ctx->tabela_funcoes->total_funcoes = 0;
+    ctx->tabela_funcoes->capacidade_indice = CAPACIDADE_INICIAL_FUNCOES;
+    ctx->tabela_funcoes->indice = (FuncaoDeclarada**) alocar_na_regiao(ctx, REGIAO_SEMANTICO, sizeof(FuncaoDeclarada*) * CAPACIDADE_INICIAL_FUNCOES);
+    memset(ctx->tabela_funcoes->indice, 0, sizeof(FuncaoDeclarada*) * CAPACIDADE_INICIAL_FUNCOES);
+
+    ctx->verificacoes_adiadas = NULL;
+    if (ctx->escalonador != NULL && ctx->fluxo_tokens->total >= MINIMO_TOKENS_VERIFICACAO_ADIADA) {
+        ctx->verificacoes_adiadas = (VerificacoesAdiadas*) alocar_na_regiao(ctx, REGIAO_SEMANTICO, sizeof(VerificacoesAdiadas));
+        ctx->verificacoes_adiadas->itens = NULL;
+        ctx->verificacoes_adiadas->total = 0;
+        ctx->verificacoes_adiadas->capacidade = 0;
+    }
 }
 
-void destruir_analisador_semantico() {
-    if (tabela_funcoes) {
-        FuncaoDeclarada* atual = tabela_funcoes->primeira;
-        while (atual != NULL) {
-            FuncaoDeclarada* proxima = atual->proxima;
-            liberar_memoria(atual->nome_funcao, strlen(atual->nome_funcao) + 1);
-            liberar_memoria(atual, sizeof(FuncaoDeclarada));
-            atual = proxima;
-        }
-        liberar_memoria(tabela_funcoes, sizeof(TabelaFuncoes));
+void destruir_analisador_semantico(ContextoCompilador* ctx) {
+    /* Funções, linhas de chamada e índice vivem na região semântica. */
+    pool_reiniciar(&ctx->pool_funcoes);
+    if (ctx->verificacoes_adiadas != NULL) {
+        liberar_memoria(ctx, ctx->verificacoes_adiadas->itens,
+                        sizeof(VerificacaoAdiada) * ctx->verificacoes_adiadas->capacidade, CATEGORIA_FUNCOES);
     }
+    liberar_regiao(ctx, REGIAO_SEMANTICO);
+    ctx->tabela_funcoes = NULL;
+    ctx->verificacoes_adiadas = NULL;
 }
 
 /* --- FUNÇÕES AUXILIARES --- */
 
-void adicionar_funcao_declarada(const char* nome, int linha) {
-    FuncaoDeclarada* nova = (FuncaoDeclarada*) alocar_memoria(sizeof(FuncaoDeclarada));
+/* Espalha ids consecutivos pelo índice (hash multiplicativo de Knuth). */
+static int slot_funcao(int id_nome, int capacidade) {
+    return (int)(((unsigned int) id_nome * 2654435761u) & (unsigned int)(capacidade - 1));
+}
+
+/* Insere ou substitui a entrada do id no índice; uma redeclaração passa a ser a encontrada. */
+static void indexar_funcao(FuncaoDeclarada** indice, int capacidade, FuncaoDeclarada* funcao) {
+    int slot = slot_funcao(funcao->id_nome, capacidade);
+    while (indice[slot] != NULL && indice[slot]->id_nome != funcao->id_nome) {
+        slot = (slot + 1) & (capacidade - 1);
+    }
+    indice[slot] = funcao;
+}
+
+static void expandir_indice_funcoes(ContextoCompilador* ctx) {
+    int nova_capacidade = ctx->tabela_funcoes->capacidade_indice * 2;
+    FuncaoDeclarada** novo = (FuncaoDeclarada**) alocar_na_regiao(ctx, REGIAO_SEMANTICO, sizeof(FuncaoDeclarada*) * nova_capacidade);
+    memset(novo, 0, sizeof(FuncaoDeclarada*) * nova_capacidade);
+
+    /* O índice antigo já guarda apenas a declaração mais recente de cada nome. */
+    for (int i = 0; i < ctx->tabela_funcoes->capacidade_indice; i++) {
+        if (ctx->tabela_funcoes->indice[i] != NULL) {
+            indexar_funcao(novo, nova_capacidade, ctx->tabela_funcoes->indice[i]);
+        }
+    }
+
+    ctx->tabela_funcoes->indice = novo;
+    ctx->tabela_funcoes->capacidade_indice = nova_capacidade;
+}
+
+void adicionar_funcao_declarada(ContextoCompilador* ctx, const char* nome, int linha, int coluna) {
+    FuncaoDeclarada* nova = (FuncaoDeclarada*) pool_alocar(&ctx->pool_funcoes);
 
-    size_t len_nome = strlen(nome) + 1;
-    nova->nome_funcao = (char*) alocar_memoria(len_nome);
-    strncpy(nova->nome_funcao, nome, len_nome);
+    nova->id_nome = internar_nome(ctx, nome, strlen(nome));
+    nova->nome_funcao = nome_por_id(ctx, nova->id_nome);
 
     nova->linha_declaracao = linha;
-    nova->foi_chamada = 0;
-    nova->proxima = tabela_funcoes->primeira;
+    nova->coluna_declaracao = coluna;
+    nova->total_chamadas = 0;
+    nova->linhas_chamada = NULL;
+    nova->capacidade_linhas = 0;
+    nova->proxima = ctx->tabela_funcoes->primeira;
+
+    ctx->tabela_funcoes->primeira = nova;
+    ctx->tabela_funcoes->total_funcoes++;
 
-    tabela_funcoes->primeira = nova;
-    tabela_funcoes->total_funcoes++;
+    if (ctx->tabela_funcoes->total_funcoes * 2 > ctx->tabela_funcoes->capacidade_indice) {
+        expandir_indice_funcoes(ctx);
+    }
+    indexar_funcao(ctx->tabela_funcoes->indice, ctx->tabela_funcoes->capacidade_indice, nova);
 }
 
-FuncaoDeclarada* buscar_funcao_declarada(const char* nome) {
-    FuncaoDeclarada* atual = tabela_funcoes->primeira;
-    while (atual != NULL) {
-        if (strcmp(atual->nome_funcao, nome) == 0) {
-            return atual;
+FuncaoDeclarada* buscar_funcao_declarada(ContextoCompilador* ctx, const char* nome) {
+    int id = buscar_id_nome(ctx, nome, strlen(nome));
+    if (id < 0) {
+        return NULL;
+    }
+
+    int mascara = ctx->tabela_funcoes->capacidade_indice - 1;
+    int slot = slot_funcao(id, ctx->tabela_funcoes->capacidade_indice);
+    while (ctx->tabela_funcoes->indice[slot] != NULL) {
+        if (ctx->tabela_funcoes->indice[slot]->id_nome == id) {
+            return ctx->tabela_funcoes->indice[slot];
         }
-        atual = atual->proxima;
+        slot = (slot + 1) & mascara;
     }
     return NULL;
 }
 
-void marcar_funcao_chamada(const char* nome) {
-    FuncaoDeclarada* funcao = buscar_funcao_declarada(nome);
-    if (funcao) {
-        funcao->foi_chamada = 1;
+void marcar_funcao_chamada(ContextoCompilador* ctx, const char* nome, int linha) {
+    FuncaoDeclarada* funcao = buscar_funcao_declarada(ctx, nome);
+    if (funcao == NULL) {
+        return;
+    }
+
+    if (funcao->total_chamadas == funcao->capacidade_linhas) {
+        int nova_capacidade = funcao->capacidade_linhas ? funcao->capacidade_linhas * 2 : CAPACIDADE_INICIAL_CHAMADAS;
+        /* O vetor antigo fica na região; dobrando, o desperdício é menor que o vetor atual. */
+        int* novas = (int*) alocar_na_regiao(ctx, REGIAO_SEMANTICO, sizeof(int) * nova_capacidade);
+        if (funcao->linhas_chamada) {
+            memcpy(novas, funcao->linhas_chamada, sizeof(int) * funcao->total_chamadas);
+        }
+        funcao->linhas_chamada = novas;
+        funcao->capacidade_linhas = nova_capacidade;
     }
+    funcao->linhas_chamada[funcao->total_chamadas++] = linha;
 }
 
 const char* tipo_para_string(TipoDado tipo) {
@@ -125,107 +260,165 @@ int tipos_compativeis_comparacao(TipoDado tipo1, TipoDado tipo2) {
            (tipo2 == TIPO_INTEIRO || tipo2 == TIPO_DECIMAL);
 }
 
-/* --- VERIFICAÇÕES SEMÂNTICAS --- */
+/* --- AVALIAÇÃO DAS VERIFICAÇÕES --- */
 
-int verificar_variavel_declarada(const char* nome_variavel, int linha) {
-    EntradaTabela* entrada = buscar_variavel(nome_variavel);
-    if (entrada == NULL) {
-        fprintf(stderr, "ALERTA SEMÂNTICO: Variável '%s' não foi declarada (linha %d).\n",
-                nome_variavel, linha);
-        alerta_semantico_emitido = 1;
-        return 0;
-    }
-    return 1;
+/*
+ * Cada verificação é dividida em duas partes: avaliar_* decide o alerta sem
+ * escrever nada nem alterar o contexto, e emitir_alerta() o escreve. A mesma
+ * avaliação serve ao modo imediato, chamado pelo parser, e ao modo adiado, em
+ * que as avaliações de cada função rodam em paralelo e os alertas são escritos
+ * depois, na ordem do código.
+ */
+
+static AlertaSemantico sem_alerta() {
+    AlertaSemantico alerta;
+    memset(&alerta, 0, sizeof(alerta));
+    alerta.tipo = ALERTA_NENHUM;
+    return alerta;
 }
 
-int verificar_funcao_declarada(const char* nome_funcao, int linha) {
-    FuncaoDeclarada* funcao = buscar_funcao_declarada(nome_funcao);
-    if (funcao == NULL) {
-        fprintf(stderr, "ALERTA SEMÂNTICO: Função '%s' não foi declarada (linha %d).\n",
-                nome_funcao, linha);
-        alerta_semantico_emitido = 1;
-        return 0;
+static AlertaSemantico novo_alerta(TipoAlerta tipo, const char* nome, const char* operador, int linha, int coluna) {
+    AlertaSemantico alerta = sem_alerta();
+    alerta.tipo = tipo;
+    alerta.nome = nome;
+    alerta.operador = operador;
+    alerta.linha = linha;
+    alerta.coluna = coluna;
+    return alerta;
+}
+
+/* Escreve o alerta; retorna 1 se não havia alerta (verificação aprovada), 0 caso contrário. */
+static int emitir_alerta(ContextoCompilador* ctx, const AlertaSemantico* alerta) {
+    switch (alerta->tipo) {
+        case ALERTA_NENHUM:
+            return 1;
+        case ALERTA_VARIAVEL_NAO_DECLARADA:
+            fprintf(ctx->erros, "ALERTA SEMÂNTICO: Variável '%s' não foi declarada (linha %d, coluna %d).\n",
+                    alerta->nome, alerta->linha, alerta->coluna);
+            break;
+        case ALERTA_FUNCAO_NAO_DECLARADA:
+            fprintf(ctx->erros, "ALERTA SEMÂNTICO: Função '%s' não foi declarada (linha %d, coluna %d).\n",
+                    alerta->nome, alerta->linha, alerta->coluna);
+            break;
+        case ALERTA_ATRIBUICAO_INCOMPATIVEL:
+            fprintf(ctx->erros, "ALERTA SEMÂNTICO: Incompatibilidade de tipos na atribuição (linha %d, coluna %d). "
+                            "Variável '%s' é do tipo '%s', mas está recebendo valor do tipo '%s'.\n",
+                    alerta->linha, alerta->coluna, alerta->nome, tipo_para_string(alerta->tipo1), tipo_para_string(alerta->tipo2));
+            break;
+        case ALERTA_TEXTO_COM_NUMERO:
+            fprintf(ctx->erros, "ALERTA SEMÂNTICO: Operador '%s' não pode ser usado para comparar texto com número (linha %d, coluna %d).\n",
+                    alerta->operador, alerta->linha, alerta->coluna);
+            break;
+        case ALERTA_COMPARACAO_INCOMPATIVEL:
+            fprintf(ctx->erros, "ALERTA SEMÂNTICO: Tipos incompatíveis na comparação '%s' vs '%s' com operador '%s' (linha %d, coluna %d).\n",
+                    tipo_para_string(alerta->tipo1), tipo_para_string(alerta->tipo2), alerta->operador, alerta->linha, alerta->coluna);
+            break;
+        case ALERTA_OPERADOR_TEXTO:
+            fprintf(ctx->erros, "ALERTA SEMÂNTICO: Operador '%s' não é válido para tipo texto. "
+                            "Use apenas '==' ou '<>' (linha %d, coluna %d).\n", alerta->operador, alerta->linha, alerta->coluna);
+            break;
+        case ALERTA_OPERACAO_MATEMATICA_TEXTO:
+            fprintf(ctx->erros, "ALERTA SEMÂNTICO: Operador matemático '%s' não pode ser usado com tipo texto (linha %d, coluna %d).\n",
+                    alerta->operador, alerta->linha, alerta->coluna);
+            break;
+        case ALERTA_TEXTO_EXCEDE_LIMITE:
+            fprintf(ctx->erros, "ALERTA SEMÂNTICO: Texto atribuído à variável '%s' excede o tamanho máximo de %d caracteres (linha %d, coluna %d).\n",
+                    alerta->nome, alerta->limite, alerta->linha, alerta->coluna);
+            break;
+        case ALERTA_CASAS_ANTES_DO_PONTO:
+            fprintf(ctx->erros, "ALERTA SEMÂNTICO: Valor decimal para variável '%s' possui %d casas antes do ponto, "
+                            "mas o limite é %d (linha %d, coluna %d).\n",
+                    alerta->nome, alerta->casas, alerta->limite, alerta->linha, alerta->coluna);
+            break;
+        case ALERTA_CASAS_DEPOIS_DO_PONTO:
+            fprintf(ctx->erros, "ALERTA SEMÂNTICO: Valor decimal para variável '%s' possui %d casas depois do ponto, "
+                            "mas o limite é %d (linha %d, coluna %d).\n",
+                    alerta->nome, alerta->casas, alerta->limite, alerta->linha, alerta->coluna);
+            break;
     }
+    ctx->alerta_semantico_emitido = 1;
+    return 0;
+}
 
-    marcar_funcao_chamada(nome_funcao);
-    return 1;
+/*
+ * Busca uma variável considerando apenas as 'visiveis' primeiras declarações:
+ * uma verificação adiada enxerga a tabela como ela estava no ponto do código
+ * em que foi feita. Os nomes são únicos, então basta comparar a ordem.
+ */
+static EntradaTabela* buscar_variavel_visivel(ContextoCompilador* ctx, const char* nome, int visiveis) {
+    EntradaTabela* entrada = buscar_variavel(ctx, nome);
+    return (entrada != NULL && entrada->ordem < visiveis) ? entrada : NULL;
+}
+
+/* Declarações visíveis para uma verificação feita agora. */
+static int variaveis_declaradas(ContextoCompilador* ctx) {
+    return ctx->tabela_simbolos->total_entradas;
+}
+
+static AlertaSemantico avaliar_variavel_declarada(ContextoCompilador* ctx, const char* nome_variavel, int visiveis, int linha, int coluna) {
+    if (buscar_variavel_visivel(ctx, nome_variavel, visiveis) == NULL) {
+        return novo_alerta(ALERTA_VARIAVEL_NAO_DECLARADA, nome_variavel, NULL, linha, coluna);
+    }
+    return sem_alerta();
 }
 
-int verificar_atribuicao_tipos(const char* nome_variavel, TipoDado tipo_valor, int linha) {
-    EntradaTabela* entrada = buscar_variavel(nome_variavel);
+static AlertaSemantico avaliar_atribuicao_tipos(ContextoCompilador* ctx, const char* nome_variavel, TipoDado tipo_valor, int visiveis, int linha, int coluna) {
+    EntradaTabela* entrada = buscar_variavel_visivel(ctx, nome_variavel, visiveis);
     if (entrada == NULL) {
-        return verificar_variavel_declarada(nome_variavel, linha);
+        return avaliar_variavel_declarada(ctx, nome_variavel, visiveis, linha, coluna);
     }
 
     if (!tipos_compativeis_atribuicao(entrada->tipo, tipo_valor)) {
-        fprintf(stderr, "ALERTA SEMÂNTICO: Incompatibilidade de tipos na atribuição (linha %d). "
-                        "Variável '%s' é do tipo '%s', mas está recebendo valor do tipo '%s'.\n",
-                linha, nome_variavel, tipo_para_string(entrada->tipo), tipo_para_string(tipo_valor));
-        alerta_semantico_emitido = 1;
-        return 0;
+        AlertaSemantico alerta = novo_alerta(ALERTA_ATRIBUICAO_INCOMPATIVEL, nome_variavel, NULL, linha, coluna);
+        alerta.tipo1 = entrada->tipo;
+        alerta.tipo2 = tipo_valor;
+        return alerta;
     }
 
-    return 1;
+    return sem_alerta();
 }
 
-int verificar_comparacao_tipos(TipoDado tipo1, TipoDado tipo2, const char* operador, int linha) {
+static AlertaSemantico avaliar_comparacao_tipos(TipoDado tipo1, TipoDado tipo2, const char* operador, int linha, int coluna) {
     if (!tipos_compativeis_comparacao(tipo1, tipo2)) {
         if (tipo1 == TIPO_TEXTO || tipo2 == TIPO_TEXTO) {
-            fprintf(stderr, "ALERTA SEMÂNTICO: Operador '%s' não pode ser usado para comparar texto com número (linha %d).\n",
-                    operador, linha);
-        } else {
-            fprintf(stderr, "ALERTA SEMÂNTICO: Tipos incompatíveis na comparação '%s' vs '%s' com operador '%s' (linha %d).\n",
-                    tipo_para_string(tipo1), tipo_para_string(tipo2), operador, linha);
+            return novo_alerta(ALERTA_TEXTO_COM_NUMERO, NULL, operador, linha, coluna);
         }
-        alerta_semantico_emitido = 1;
-        return 0;
+        AlertaSemantico alerta = novo_alerta(ALERTA_COMPARACAO_INCOMPATIVEL, NULL, operador, linha, coluna);
+        alerta.tipo1 = tipo1;
+        alerta.tipo2 = tipo2;
+        return alerta;
     }
 
     // Verifica se operador é válido para texto
     if ((tipo1 == TIPO_TEXTO || tipo2 == TIPO_TEXTO) &&
         strcmp(operador, "==") != 0 && strcmp(operador, "<>") != 0) {
-        fprintf(stderr, "ALERTA SEMÂNTICO: Operador '%s' não é válido para tipo texto. "
-                        "Use apenas '==' ou '<>' (linha %d).\n", operador, linha);
-        alerta_semantico_emitido = 1;
-        return 0;
-    }
-
-    return 1;
-}
-
-int verificar_operacao_matematica_tipos(TipoDado tipo1, TipoDado tipo2, const char* operador, int linha) {
-    if (tipo1 == TIPO_TEXTO || tipo2 == TIPO_TEXTO) {
-        fprintf(stderr, "ALERTA SEMÂNTICO: Operador matemático '%s' não pode ser usado com tipo texto (linha %d).\n",
-                operador, linha);
-        alerta_semantico_emitido = 1;
-        return 0;
+        return novo_alerta(ALERTA_OPERADOR_TEXTO, NULL, operador, linha, coluna);
     }
 
-    return 1;
+    return sem_alerta();
 }
 
-int verificar_limitadores_texto(const char* nome_variavel, const char* valor_texto, int linha) {
-    EntradaTabela* entrada = buscar_variavel(nome_variavel);
+static AlertaSemantico avaliar_limitadores_texto(ContextoCompilador* ctx, const char* nome_variavel, const char* valor_texto, int visiveis, int linha, int coluna) {
+    EntradaTabela* entrada = buscar_variavel_visivel(ctx, nome_variavel, visiveis);
     if (entrada == NULL || entrada->tipo != TIPO_TEXTO || !entrada->tem_limitador) {
-        return 1; // Sem limitador ou não é texto
+        return sem_alerta(); // Sem limitador ou não é texto
     }
 
     // Remove aspas para contar caracteres
     int tamanho_valor = strlen(valor_texto) - 2; // Remove as aspas duplas
     if (tamanho_valor > entrada->limitador.tamanho1) {
-        fprintf(stderr, "ALERTA SEMÂNTICO: Texto atribuído à variável '%s' excede o tamanho máximo de %d caracteres (linha %d).\n",
-                nome_variavel, entrada->limitador.tamanho1, linha);
-        alerta_semantico_emitido = 1;
-        return 0;
+        AlertaSemantico alerta = novo_alerta(ALERTA_TEXTO_EXCEDE_LIMITE, nome_variavel, NULL, linha, coluna);
+        alerta.limite = entrada->limitador.tamanho1;
+        return alerta;
     }
 
-    return 1;
+    return sem_alerta();
 }
 
-int verificar_limitadores_decimal(const char* nome_variavel, const char* valor_decimal, int linha) {
-    EntradaTabela* entrada = buscar_variavel(nome_variavel);
+static AlertaSemantico avaliar_limitadores_decimal(ContextoCompilador* ctx, const char* nome_variavel, const char* valor_decimal, int visiveis, int linha, int coluna) {
+    EntradaTabela* entrada = buscar_variavel_visivel(ctx, nome_variavel, visiveis);
     if (entrada == NULL || entrada->tipo != TIPO_DECIMAL || !entrada->tem_limitador) {
-        return 1; // Sem limitador ou não é decimal
+        return sem_alerta(); // Sem limitador ou não é decimal
     }
 
     char* ponto = strchr(valor_decimal, '.');
@@ -233,39 +426,319 @@ int verificar_limitadores_decimal(const char* nome_variavel, const char* valor_d
     int casas_depois = ponto ? strlen(ponto + 1) : 0;
 
     if (casas_antes > entrada->limitador.tamanho1) {
-        fprintf(stderr, "ALERTA SEMÂNTICO: Valor decimal para variável '%s' possui %d casas antes do ponto, "
-                        "mas o limite é %d (linha %d).\n",
-                nome_variavel, casas_antes, entrada->limitador.tamanho1, linha);
-        alerta_semantico_emitido = 1;
-        return 0;
+        AlertaSemantico alerta = novo_alerta(ALERTA_CASAS_ANTES_DO_PONTO, nome_variavel, NULL, linha, coluna);
+        alerta.casas = casas_antes;
+        alerta.limite = entrada->limitador.tamanho1;
+        return alerta;
     }
 
     if (casas_depois > entrada->limitador.tamanho2) {
-        fprintf(stderr, "ALERTA SEMÂNTICO: Valor decimal para variável '%s' possui %d casas depois do ponto, "
-                        "mas o limite é %d (linha %d).\n",
-                nome_variavel, casas_depois, entrada->limitador.tamanho2, linha);
-        alerta_semantico_emitido = 1;
-        return 0;
+        AlertaSemantico alerta = novo_alerta(ALERTA_CASAS_DEPOIS_DO_PONTO, nome_variavel, NULL, linha, coluna);
+        alerta.casas = casas_depois;
+        alerta.limite = entrada->limitador.tamanho2;
+        return alerta;
+    }
+
+    return sem_alerta();
+}
+
+/*
+ * Um limitador só é verificado quando a variável tem o mesmo tipo do valor,
+ * caso em que a verificação de tipos passa: cada atribuição gera no máximo um
+ * alerta.
+ */
+static AlertaSemantico avaliar_semantica_atribuicao(ContextoCompilador* ctx, const char* nome_variavel, const char* valor, TipoToken tipo_valor,
+                                                    int visiveis, int linha, int coluna) {
+    TipoDado tipo_inferido;
+
+    if (tipo_valor == TOKEN_LITERAL_TEXTO) {
+        tipo_inferido = TIPO_TEXTO;
+        AlertaSemantico alerta = avaliar_limitadores_texto(ctx, nome_variavel, valor, visiveis, linha, coluna);
+        if (alerta.tipo != ALERTA_NENHUM) return alerta;
+    } else if (tipo_valor == TOKEN_LITERAL_NUMERO) {
+        tipo_inferido = inferir_tipo_literal(valor);
+        if (tipo_inferido == TIPO_DECIMAL) {
+            AlertaSemantico alerta = avaliar_limitadores_decimal(ctx, nome_variavel, valor, visiveis, linha, coluna);
+            if (alerta.tipo != ALERTA_NENHUM) return alerta;
+        }
+    } else if (tipo_valor == TOKEN_ID_VARIAVEL) {
+        EntradaTabela* entrada = buscar_variavel_visivel(ctx, valor, visiveis);
+        if (entrada) {
+            tipo_inferido = entrada->tipo;
+        } else {
+            return avaliar_variavel_declarada(ctx, valor, visiveis, linha, coluna);
+        }
+    } else {
+        tipo_inferido = TIPO_INTEIRO; // Padrão para expressões
+    }
+
+    return avaliar_atribuicao_tipos(ctx, nome_variavel, tipo_inferido, visiveis, linha, coluna);
+}
+
+/* Tipo de um operando de comparação; zera 'declarado' se o operando é uma variável não declarada. */
+static TipoDado tipo_operando(ContextoCompilador* ctx, const char* operando, TipoToken tipo, int visiveis, int* declarado) {
+    *declarado = 1;
+    if (tipo == TOKEN_LITERAL_TEXTO) {
+        return TIPO_TEXTO;
+    } else if (tipo == TOKEN_LITERAL_NUMERO) {
+        return inferir_tipo_literal(operando);
+    } else if (tipo == TOKEN_ID_VARIAVEL) {
+        EntradaTabela* entrada = buscar_variavel_visivel(ctx, operando, visiveis);
+        if (entrada) {
+            return entrada->tipo;
+        }
+        *declarado = 0;
+    }
+    return TIPO_INTEIRO;
+}
+
+static AlertaSemantico avaliar_semantica_comparacao(ContextoCompilador* ctx, const char* operando1, TipoToken tipo1,
+                                                    const char* operando2, TipoToken tipo2,
+                                                    const char* operador, int visiveis, int linha, int coluna) {
+    int declarado;
+
+    // Determina tipo do primeiro operando
+    TipoDado tipo_op1 = tipo_operando(ctx, operando1, tipo1, visiveis, &declarado);
+    if (!declarado) {
+        return avaliar_variavel_declarada(ctx, operando1, visiveis, linha, coluna);
+    }
+
+    // Determina tipo do segundo operando
+    TipoDado tipo_op2 = tipo_operando(ctx, operando2, tipo2, visiveis, &declarado);
+    if (!declarado) {
+        return avaliar_variavel_declarada(ctx, operando2, visiveis, linha, coluna);
+    }
+
+    return avaliar_comparacao_tipos(tipo_op1, tipo_op2, operador, linha, coluna);
+}
+
+/* --- VERIFICAÇÕES ADIADAS --- */
+
+/*
+ * Com um escalonador no contexto e um programa de pelo menos
+ * MINIMO_TOKENS_VERIFICACAO_ADIADA tokens, o parser apenas registra as
+ * verificações de variáveis, atribuições e comparações. Elas são avaliadas em
+ * paralelo, em lotes formados por funções inteiras, quando o buffer enche,
+ * antes de cada erro sintático e ao fim do programa; os alertas saem na ordem
+ * do código.
+ * Chamadas de função continuam avaliadas na hora, pois contam as chamadas,
+ * mas seus alertas também esperam a vez no buffer.
+ */
+
+typedef struct {
+    ContextoCompilador* ctx;
+    int inicio;
+    int fim;
+} TarefaVerificacao;
+
+static void registrar_verificacao(ContextoCompilador* ctx, TipoVerificacao tipo, const char* nome, const char* valor,
+                                  const char* operador, TipoToken tipo1, TipoToken tipo2, int linha, int coluna) {
+    VerificacoesAdiadas* adiadas = ctx->verificacoes_adiadas;
+    if (adiadas->total == MAXIMO_VERIFICACOES_ADIADAS) {
+        concluir_verificacoes_semanticas(ctx);
+    } else if (adiadas->total == adiadas->capacidade) {
+        /* O buffer antigo só é liberado depois que o novo foi obtido dentro do orçamento. */
+        int capacidade = adiadas->capacidade == 0 ? CAPACIDADE_INICIAL_VERIFICACOES : adiadas->capacidade * 2;
+        VerificacaoAdiada* itens = (VerificacaoAdiada*) alocar_memoria(ctx, sizeof(VerificacaoAdiada) * capacidade, CATEGORIA_FUNCOES);
+        if (adiadas->itens != NULL) {
+            memcpy(itens, adiadas->itens, sizeof(VerificacaoAdiada) * adiadas->total);
+            liberar_memoria(ctx, adiadas->itens, sizeof(VerificacaoAdiada) * adiadas->capacidade, CATEGORIA_FUNCOES);
+        }
+        adiadas->itens = itens;
+        adiadas->capacidade = capacidade;
+    }
+    VerificacaoAdiada* verificacao = &adiadas->itens[adiadas->total++];
+    verificacao->tipo = tipo;
+    /* O parser passa lexemas de tokens, canônicos e estáveis até o fim da compilação: basta guardar os ponteiros. */
+    verificacao->nome = nome;
+    verificacao->valor = valor;
+    verificacao->operador = operador;
+    verificacao->tipo1 = tipo1;
+    verificacao->tipo2 = tipo2;
+    verificacao->linha = linha;
+    verificacao->coluna = coluna;
+    verificacao->visiveis = variaveis_declaradas(ctx);
+    verificacao->funcao = ctx->tabela_funcoes->total_funcoes;
+    verificacao->alerta = sem_alerta();
+}
+
+static void avaliar_verificacao(ContextoCompilador* ctx, VerificacaoAdiada* v) {
+    switch (v->tipo) {
+        case VERIFICACAO_VARIAVEL:
+            v->alerta = avaliar_variavel_declarada(ctx, v->nome, v->visiveis, v->linha, v->coluna);
+            break;
+        case VERIFICACAO_ATRIBUICAO:
+            v->alerta = avaliar_semantica_atribuicao(ctx, v->nome, v->valor, v->tipo1, v->visiveis, v->linha, v->coluna);
+            break;
+        case VERIFICACAO_COMPARACAO:
+            v->alerta = avaliar_semantica_comparacao(ctx, v->nome, v->tipo1, v->valor, v->tipo2, v->operador, v->visiveis, v->linha, v->coluna);
+            break;
+        case VERIFICACAO_AVALIADA:
+            break;
+    }
+}
+
+/* Tarefa: avalia uma faixa de verificações. Só lê as tabelas, que o parser não altera enquanto aguarda. */
+static void executar_tarefa_verificacao(void* argumento) {
+    TarefaVerificacao* tarefa = (TarefaVerificacao*) argumento;
+    for (int i = tarefa->inicio; i < tarefa->fim; i++) {
+        avaliar_verificacao(tarefa->ctx, &tarefa->ctx->verificacoes_adiadas->itens[i]);
+    }
+}
+
+void concluir_verificacoes_semanticas(ContextoCompilador* ctx) {
+    VerificacoesAdiadas* adiadas = ctx->verificacoes_adiadas;
+    if (adiadas == NULL || adiadas->total == 0) {
+        return;
+    }
+
+    /* Uma tarefa por função, agrupando funções pequenas até o mínimo por tarefa. */
+    TarefaVerificacao tarefas[MAXIMO_TAREFAS_VERIFICACAO];
+    int total_tarefas = 0;
+    int inicio = 0;
+    for (int i = 1; i <= adiadas->total; i++) {
+        int fim_de_funcao = i == adiadas->total || adiadas->itens[i].funcao != adiadas->itens[i - 1].funcao;
+        if (fim_de_funcao && i - inicio >= MINIMO_VERIFICACOES_POR_TAREFA) {
+            tarefas[total_tarefas++] = (TarefaVerificacao){ctx, inicio, i};
+            inicio = i;
+        }
+    }
+    if (inicio < adiadas->total) {
+        tarefas[total_tarefas++] = (TarefaVerificacao){ctx, inicio, adiadas->total};
+    }
+
+    if (ctx->escalonador != NULL && total_tarefas > 1) {
+        GrupoTarefas grupo;
+        inicializar_grupo_tarefas(&grupo);
+        for (int i = 0; i < total_tarefas; i++) {
+            submeter_tarefa(ctx->escalonador, &grupo, executar_tarefa_verificacao, &tarefas[i]);
+        }
+        aguardar_grupo_tarefas(ctx->escalonador, &grupo);
+    } else {
+        for (int i = 0; i < total_tarefas; i++) {
+            executar_tarefa_verificacao(&tarefas[i]);
+        }
+    }
+
+    for (int i = 0; i < adiadas->total; i++) {
+        emitir_alerta(ctx, &adiadas->itens[i].alerta);
+    }
+    adiadas->total = 0;
+}
+
+/* --- VERIFICAÇÕES SEMÂNTICAS --- */
+
+int verificar_variavel_declarada(ContextoCompilador* ctx, const char* nome_variavel, int linha, int coluna) {
+    if (ctx->verificacoes_adiadas != NULL) {
+        registrar_verificacao(ctx, VERIFICACAO_VARIAVEL, nome_variavel, NULL, NULL, TOKEN_ERRO, TOKEN_ERRO, linha, coluna);
+        return 1;
+    }
+    AlertaSemantico alerta = avaliar_variavel_declarada(ctx, nome_variavel, variaveis_declaradas(ctx), linha, coluna);
+    return emitir_alerta(ctx, &alerta);
+}
+
+int verificar_funcao_declarada(ContextoCompilador* ctx, const char* nome_funcao, int linha, int coluna) {
+    FuncaoDeclarada* funcao = buscar_funcao_declarada(ctx, nome_funcao);
+    if (funcao == NULL) {
+        AlertaSemantico alerta = novo_alerta(ALERTA_FUNCAO_NAO_DECLARADA, nome_funcao, NULL, linha, coluna);
+        if (ctx->verificacoes_adiadas != NULL) {
+            registrar_verificacao(ctx, VERIFICACAO_AVALIADA, nome_funcao, NULL, NULL, TOKEN_ERRO, TOKEN_ERRO, linha, coluna);
+            VerificacoesAdiadas* adiadas = ctx->verificacoes_adiadas;
+            adiadas->itens[adiadas->total - 1].alerta = alerta;
+            return 0;
+        }
+        return emitir_alerta(ctx, &alerta);
+    }
+
+    marcar_funcao_chamada(ctx, nome_funcao, linha);
+    return 1;
+}
+
+int verificar_atribuicao_tipos(ContextoCompilador* ctx, const char* nome_variavel, TipoDado tipo_valor, int linha, int coluna) {
+    AlertaSemantico alerta = avaliar_atribuicao_tipos(ctx, nome_variavel, tipo_valor, variaveis_declaradas(ctx), linha, coluna);
+    return emitir_alerta(ctx, &alerta);
+}
+
+int verificar_comparacao_tipos(ContextoCompilador* ctx, TipoDado tipo1, TipoDado tipo2, const char* operador, int linha, int coluna) {
+    AlertaSemantico alerta = avaliar_comparacao_tipos(tipo1, tipo2, operador, linha, coluna);
+    return emitir_alerta(ctx, &alerta);
+}
+
+int verificar_operacao_matematica_tipos(ContextoCompilador* ctx, TipoDado tipo1, TipoDado tipo2, const char* operador, int linha, int coluna) {
+    if (tipo1 == TIPO_TEXTO || tipo2 == TIPO_TEXTO) {
+        AlertaSemantico alerta = novo_alerta(ALERTA_OPERACAO_MATEMATICA_TEXTO, NULL, operador, linha, coluna);
+        return emitir_alerta(ctx, &alerta);
     }
 
     return 1;
 }
 
-void verificar_funcoes_nao_utilizadas() {
-    FuncaoDeclarada* atual = tabela_funcoes->primeira;
+int verificar_limitadores_texto(ContextoCompilador* ctx, const char* nome_variavel, const char* valor_texto, int linha, int coluna) {
+    AlertaSemantico alerta = avaliar_limitadores_texto(ctx, nome_variavel, valor_texto, variaveis_declaradas(ctx), linha, coluna);
+    return emitir_alerta(ctx, &alerta);
+}
+
+int verificar_limitadores_decimal(ContextoCompilador* ctx, const char* nome_variavel, const char* valor_decimal, int linha, int coluna) {
+    AlertaSemantico alerta = avaliar_limitadores_decimal(ctx, nome_variavel, valor_decimal, variaveis_declaradas(ctx), linha, coluna);
+    return emitir_alerta(ctx, &alerta);
+}
+
+void verificar_funcoes_nao_utilizadas(ContextoCompilador* ctx) {
+    FuncaoDeclarada* atual = ctx->tabela_funcoes->primeira;
     while (atual != NULL) {
-        if (!atual->foi_chamada && strcmp(atual->nome_funcao, "principal") != 0) {
-            fprintf(stderr, "ALERTA SEMÂNTICO: Função '%s' foi declarada na linha %d mas nunca foi utilizada.\n",
-                    atual->nome_funcao, atual->linha_declaracao);
-            alerta_semantico_emitido = 1;
+        if (atual->total_chamadas == 0 && strcmp(atual->nome_funcao, "principal") != 0) {
+            fprintf(ctx->erros, "ALERTA SEMÂNTICO: Função '%s' foi declarada na linha %d, coluna %d mas nunca foi utilizada.\n",
+                    atual->nome_funcao, atual->linha_declaracao, atual->coluna_declaracao);
+            ctx->alerta_semantico_emitido = 1;
         }
         atual = atual->proxima;
     }
 }
 
+static void exibir_funcoes_mais_chamadas(ContextoCompilador* ctx) {
+    if (ctx->tabela_funcoes->total_funcoes == 0) {
+        return;
+    }
+
+    /* Seleciona as funções com mais chamadas (seleção parcial: a lista de destaque é curta). */
+    FuncaoDeclarada** ordenadas = (FuncaoDeclarada**) alocar_memoria(ctx, sizeof(FuncaoDeclarada*) * ctx->tabela_funcoes->total_funcoes, CATEGORIA_FUNCOES);
+    int total = 0;
+    for (FuncaoDeclarada* atual = ctx->tabela_funcoes->primeira; atual != NULL; atual = atual->proxima) {
+        if (atual->total_chamadas > 0) {
+            ordenadas[total++] = atual;
+        }
+    }
+
+    if (total > 0) {
+        fprintf(ctx->saida, "Funções mais chamadas:\n");
+    }
+    for (int i = 0; i < total && i < TOTAL_FUNCOES_MAIS_CHAMADAS; i++) {
+        int maior = i;
+        for (int j = i + 1; j < total; j++) {
+            if (ordenadas[j]->total_chamadas > ordenadas[maior]->total_chamadas) {
+                maior = j;
+            }
+        }
+        FuncaoDeclarada* funcao = ordenadas[maior];
+        ordenadas[maior] = ordenadas[i];
+        ordenadas[i] = funcao;
+
+        fprintf(ctx->saida, "  %-20s %d chamada(s) nas linhas", funcao->nome_funcao, funcao->total_chamadas);
+        for (int k = 0; k < funcao->total_chamadas && k < MAX_LINHAS_RELATORIO; k++) {
+            fprintf(ctx->saida, "%s%d", k ? ", " : " ", funcao->linhas_chamada[k]);
+        }
+        if (funcao->total_chamadas > MAX_LINHAS_RELATORIO) {
+            fprintf(ctx->saida, ", ...");
+        }
+        fprintf(ctx->saida, "\n");
+    }
+
+    liberar_memoria(ctx, ordenadas, sizeof(FuncaoDeclarada*) * ctx->tabela_funcoes->total_funcoes, CATEGORIA_FUNCOES);
+}
+
 /* --- FUNÇÕES DE ANÁLISE SEMÂNTICA --- */
 
-TipoDado analisar_tipo_expressao(Token* tokens, int inicio, int fim) {
+TipoDado analisar_tipo_expressao(ContextoCompilador* ctx, Token* tokens, int inicio, int fim) {
     // Esta função seria mais complexa em uma implementação completa
     // Por simplicidade, vamos inferir o tipo baseado no primeiro token relevante
 
@@ -275,7 +748,7 @@ TipoDado analisar_tipo_expressao(Token* tokens, int inicio, int fim) {
         } else if (tokens[i].tipo == TOKEN_LITERAL_TEXTO) {
             return TIPO_TEXTO;
         } else if (tokens[i].tipo == TOKEN_ID_VARIAVEL) {
-            EntradaTabela* entrada = buscar_variavel(tokens[i].lexema);
+            EntradaTabela* entrada = buscar_variavel(ctx, tokens[i].lexema);
             if (entrada) {
                 return entrada->tipo;
             }
@@ -285,91 +758,44 @@ TipoDado analisar_tipo_expressao(Token* tokens, int inicio, int fim) {
     return TIPO_INTEIRO; // Tipo padrão se não conseguir inferir
 }
 
-void analisar_semantica_atribuicao(const char* nome_variavel, const char* valor, TipoToken tipo_valor, int linha) {
-    TipoDado tipo_inferido;
-
-    if (tipo_valor == TOKEN_LITERAL_TEXTO) {
-        tipo_inferido = TIPO_TEXTO;
-        verificar_limitadores_texto(nome_variavel, valor, linha);
-    } else if (tipo_valor == TOKEN_LITERAL_NUMERO) {
-        tipo_inferido = inferir_tipo_literal(valor);
-        if (tipo_inferido == TIPO_DECIMAL) {
-            verificar_limitadores_decimal(nome_variavel, valor, linha);
-        }
-    } else if (tipo_valor == TOKEN_ID_VARIAVEL) {
-        EntradaTabela* entrada = buscar_variavel(valor);
-        if (entrada) {
-            tipo_inferido = entrada->tipo;
-        } else {
-            verificar_variavel_declarada(valor, linha);
-            return;
-        }
-    } else {
-        tipo_inferido = TIPO_INTEIRO; // Padrão para expressões
+void analisar_semantica_atribuicao(ContextoCompilador* ctx, const char* nome_variavel, const char* valor, TipoToken tipo_valor, int linha, int coluna) {
+    if (ctx->verificacoes_adiadas != NULL) {
+        registrar_verificacao(ctx, VERIFICACAO_ATRIBUICAO, nome_variavel, valor, NULL, tipo_valor, TOKEN_ERRO, linha, coluna);
+        return;
     }
-
-    verificar_atribuicao_tipos(nome_variavel, tipo_inferido, linha);
+    AlertaSemantico alerta = avaliar_semantica_atribuicao(ctx, nome_variavel, valor, tipo_valor, variaveis_declaradas(ctx), linha, coluna);
+    emitir_alerta(ctx, &alerta);
 }
 
-void analisar_semantica_comparacao(const char* operando1, TipoToken tipo1,
+void analisar_semantica_comparacao(ContextoCompilador* ctx, const char* operando1, TipoToken tipo1,
                                    const char* operando2, TipoToken tipo2,
-                                   const char* operador, int linha) {
-    TipoDado tipo_op1, tipo_op2;
-
-    // Determina tipo do primeiro operando
-    if (tipo1 == TOKEN_LITERAL_TEXTO) {
-        tipo_op1 = TIPO_TEXTO;
-    } else if (tipo1 == TOKEN_LITERAL_NUMERO) {
-        tipo_op1 = inferir_tipo_literal(operando1);
-    } else if (tipo1 == TOKEN_ID_VARIAVEL) {
-        EntradaTabela* entrada = buscar_variavel(operando1);
-        if (entrada) {
-            tipo_op1 = entrada->tipo;
-        } else {
-            verificar_variavel_declarada(operando1, linha);
-            return;
-        }
-    } else {
-        tipo_op1 = TIPO_INTEIRO;
-    }
-
-    // Determina tipo do segundo operando
-    if (tipo2 == TOKEN_LITERAL_TEXTO) {
-        tipo_op2 = TIPO_TEXTO;
-    } else if (tipo2 == TOKEN_LITERAL_NUMERO) {
-        tipo_op2 = inferir_tipo_literal(operando2);
-    } else if (tipo2 == TOKEN_ID_VARIAVEL) {
-        EntradaTabela* entrada = buscar_variavel(operando2);
-        if (entrada) {
-            tipo_op2 = entrada->tipo;
-        } else {
-            verificar_variavel_declarada(operando2, linha);
-            return;
-        }
-    } else {
-        tipo_op2 = TIPO_INTEIRO;
+                                   const char* operador, int linha, int coluna) {
+    if (ctx->verificacoes_adiadas != NULL) {
+        registrar_verificacao(ctx, VERIFICACAO_COMPARACAO, operando1, operando2, operador, tipo1, tipo2, linha, coluna);
+        return;
     }
-
-    verificar_comparacao_tipos(tipo_op1, tipo_op2, operador, linha);
+    AlertaSemantico alerta = avaliar_semantica_comparacao(ctx, operando1, tipo1, operando2, tipo2, operador, variaveis_declaradas(ctx), linha, coluna);
+    emitir_alerta(ctx, &alerta);
 }
 
-void exibir_relatorio_semantico() {
-    printf("\n------------- RELATÓRIO SEMÂNTICO -------------\n");
+void exibir_relatorio_semantico(ContextoCompilador* ctx) {
+    fprintf(ctx->saida, "\n------------- RELATÓRIO SEMÂNTICO -------------\n");
 
-    if (!alerta_semantico_emitido && !erro_semantico_encontrado) {
-        printf("✓ Análise semântica concluída sem alertas ou erros.\n");
+    if (!ctx->alerta_semantico_emitido && !ctx->erro_semantico_encontrado) {
+        fprintf(ctx->saida, "✓ Análise semântica concluída sem alertas ou erros.\n");
     } else {
-        if (alerta_semantico_emitido) {
-            printf("⚠ Alertas semânticos foram emitidos durante a análise.\n");
+        if (ctx->alerta_semantico_emitido) {
+            fprintf(ctx->saida, "⚠ Alertas semânticos foram emitidos durante a análise.\n");
         }
-        if (erro_semantico_encontrado) {
-            printf("✗ Erros semânticos foram encontrados.\n");
+        if (ctx->erro_semantico_encontrado) {
+            fprintf(ctx->saida, "✗ Erros semânticos foram encontrados.\n");
         }
     }
 
     // Verifica funções não utilizadas
-    verificar_funcoes_nao_utilizadas();
+    verificar_funcoes_nao_utilizadas(ctx);
 
-    printf("Total de funções declaradas: %d\n", tabela_funcoes->total_funcoes);
-    printf("----------------------------------------------\n");
+    fprintf(ctx->saida, "Total de funções declaradas: %d\n", ctx->tabela_funcoes->total_funcoes);
+    exibir_funcoes_mais_chamadas(ctx);
+    fprintf(ctx->saida, "----------------------------------------------\n");
 }
\ No newline at end of file